@@ -17,52 +17,792 @@
 
 #define MIN_DRAG_DIST 4.0
 
-global_var BlocksContext *blocksCtx = 0;
+// The context every internal function works on. It's per-thread so separate contexts can run on
+// separate threads at once; the entry points swap it in and restore whatever was current before.
+global_var thread_local BlocksContext *blocksCtx = 0;
+
+#define MIN_RENDER_ENTRY_CHUNK_SIZE 64
+
+inline
+u32 RenderSortKey(RenderGroup *group, u32 entryIndex) {
+    return ((u32)group->layer << RENDER_LAYER_SHIFT) | entryIndex;
+}
 
 RenderEntry *PushRenderEntry(RenderGroup *group) {
-    Assert(group->entryCount < ArrayCount(group->entries));
-    RenderEntry *entry = &group->entries[group->entryCount++];
+    RenderEntryChunk *chunk = group->lastChunk;
+    if (!chunk || chunk->count == chunk->capacity) {
+        // Size the first chunk for as many entries as this group has ever needed, so most frames only need one
+        u32 capacity = chunk ? (chunk->capacity * 2) : Max(group->highWaterCount, (u32)MIN_RENDER_ENTRY_CHUNK_SIZE);
+        
+        Arena *arena = &blocksCtx->scratch;
+        AlignArena(arena, 16);
+        RenderEntryChunk *newChunk = PushStruct(arena, RenderEntryChunk);
+        AlignArena(arena, 16);
+        newChunk->entries = PushArray(arena, RenderEntry, capacity);
+        newChunk->next = 0;
+        newChunk->count = 0;
+        newChunk->capacity = capacity;
+        
+        if (chunk) {
+            chunk->next = newChunk;
+        }
+        else {
+            group->firstChunk = newChunk;
+        }
+        group->lastChunk = newChunk;
+        group->reservedCount += capacity;
+        chunk = newChunk;
+    }
+    
+    Assert(group->entryCount <= RENDER_ENTRY_INDEX_MASK);
+    RenderEntry *entry = &chunk->entries[chunk->count++];
+    *entry = {};
+    entry->sortKey = RenderSortKey(group, group->entryCount++);
     return entry;
 }
 
 void DEBUGPushRectOutline(Rectangle rect, v4 color) {
-    RenderEntry *entry = PushRenderEntry(&blocksCtx->debugRenderGroup);
+    RenderGroup *group = &blocksCtx->blocksRenderGroup;
+    RenderLayer layer = group->layer;
+    group->layer = RenderLayer_Debug;
+    RenderEntry *entry = PushRenderEntry(group);
+    group->layer = layer;
+    
     entry->type = RenderEntryType_RectOutline;
     entry->rect = rect;
     entry->color = color;
     entry->outline = color;
 }
 
-Script *CreateScript(v2 position) {
-    Script *script = &blocksCtx->scripts[blocksCtx->scriptCount++];
-    *script = { 0 };
-    script->P = position;
-    return script;
+void InitStringTable(StringTable *table, Arena *arena) {
+    static const u32 INITIAL_BUCKET_COUNT = 256;
+    
+    *table = {};
+    table->arena = arena;
+    table->bucketCount = INITIAL_BUCKET_COUNT;
+    table->buckets = PushArray(arena, InternedString *, table->bucketCount);
+    memset(table->buckets, 0, sizeof(InternedString *) * table->bucketCount);
+    
+    for (u32 i = 0; i < STRING_SLOT_SIZE_CLASS_COUNT; ++i) {
+        InitPool(&table->slotPools[i], arena, STRING_SLOT_MIN_SIZE << i);
+    }
 }
 
-void DeleteScript(Script *script) {
-    // Find this script in the array
-    s32 scriptIdx = -1;
-    for (u32 i = 0; i < blocksCtx->scriptCount; ++i) {
-        if (&blocksCtx->scripts[i] == script) {
-            scriptIdx = i;
+u32 HashString(const char *text, u32 length) {
+    // FNV-1a
+    u32 hash = 2166136261u;
+    for (u32 i = 0; i < length; ++i) {
+        hash ^= (u8)text[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Doubles the bucket count once the table is fully loaded, to keep chains short
+void GrowStringTable(StringTable *table) {
+    u32 newBucketCount = table->bucketCount * 2;
+    InternedString **newBuckets = PushArray(table->arena, InternedString *, newBucketCount);
+    memset(newBuckets, 0, sizeof(InternedString *) * newBucketCount);
+    
+    for (u32 i = 0; i < table->bucketCount; ++i) {
+        InternedString *str = table->buckets[i];
+        while (str) {
+            InternedString *next = str->nextInBucket;
+            u32 bucketIdx = str->hash & (newBucketCount - 1);
+            str->nextInBucket = newBuckets[bucketIdx];
+            newBuckets[bucketIdx] = str;
+            str = next;
+        }
+    }
+    
+    // @NOTE: The old buckets stay in the arena. Since we always double, they never add up to more than the live buckets.
+    table->buckets = newBuckets;
+    table->bucketCount = newBucketCount;
+}
+
+// Returns the shared copy of text, adding a reference to it
+InternedString *InternString(StringTable *table, const char *text) {
+    u32 length = (u32)strlen(text);
+    u32 hash = HashString(text, length);
+    
+    InternedString **bucket = &table->buckets[hash & (table->bucketCount - 1)];
+    for (InternedString *str = *bucket; str; str = str->nextInBucket) {
+        if (str->hash == hash && str->length == length && memcmp(str->text, text, length) == 0) {
+            str->refCount++;
+            return str;
+        }
+    }
+    
+    // Find the smallest slot that fits the header and the text
+    u32 slotSize = (u32)OffsetOf(InternedString, text) + length + 1;
+    u32 sizeClass = 0;
+    while ((STRING_SLOT_MIN_SIZE << sizeClass) < slotSize) {
+        sizeClass++;
+    }
+    Assert(sizeClass < STRING_SLOT_SIZE_CLASS_COUNT);
+    
+    InternedString *str = (InternedString *)PoolAlloc(&table->slotPools[sizeClass]);
+    str->hash = hash;
+    str->length = length;
+    str->refCount = 1;
+    str->sizeClass = sizeClass;
+    memcpy(str->text, text, length + 1);
+    
+    str->nextInBucket = *bucket;
+    *bucket = str;
+    table->count++;
+    
+    if (table->count > table->bucketCount) {
+        GrowStringTable(table);
+    }
+    
+    return str;
+}
+
+// Drops a reference to str, freeing its slot when nobody is using it anymore
+void ReleaseString(StringTable *table, InternedString *str) {
+    Assert(str->refCount > 0);
+    if (--str->refCount > 0) {
+        return;
+    }
+    
+    InternedString **link = &table->buckets[str->hash & (table->bucketCount - 1)];
+    while (*link != str) {
+        Assert(*link);
+        link = &(*link)->nextInBucket;
+    }
+    *link = str->nextInBucket;
+    table->count--;
+    
+    PoolFree(&table->slotPools[str->sizeClass], str);
+}
+
+inline
+b32 IsBlockAlive(BlockHandle handle) {
+    return HandleIsLive(&blocksCtx->blockStore.handles, handle.index, handle.generation);
+}
+
+inline
+u32 GetBlockSlot(BlockHandle handle) {
+    Assert(IsBlockAlive(handle)); // Stale handle
+    return blocksCtx->blockStore.handles.entries[handle.index].slot;
+}
+
+inline
+BlockType GetBlockType(BlockHandle handle) {
+    return (BlockType)blocksCtx->blockStore.types[GetBlockSlot(handle)];
+}
+
+inline
+BlockLinks *GetBlockLinks(BlockHandle handle) {
+    return &blocksCtx->blockStore.links[GetBlockSlot(handle)];
+}
+
+inline
+BlockInput *GetBlockInput(BlockHandle handle) {
+    return &blocksCtx->blockStore.inputs[GetBlockSlot(handle)];
+}
+
+inline
+BlockLayout *GetBlockLayout(BlockHandle handle) {
+    return &blocksCtx->blockStore.layouts[GetBlockSlot(handle)];
+}
+
+inline
+ScriptHandle GetBlockScript(BlockHandle handle) {
+    return blocksCtx->blockStore.scripts[GetBlockSlot(handle)];
+}
+
+inline
+void CopyBlockSlot(BlockStore *dest, u32 destSlot, BlockStore *src, u32 srcSlot) {
+    dest->selfHandles[destSlot] = src->selfHandles[srcSlot];
+    dest->types[destSlot] = src->types[srcSlot];
+    dest->links[destSlot] = src->links[srcSlot];
+    dest->scripts[destSlot] = src->scripts[srcSlot];
+    dest->inputs[destSlot] = src->inputs[srcSlot];
+    dest->layouts[destSlot] = src->layouts[srcSlot];
+}
+
+void ReserveBlocks(BlockStore *store, u32 minCapacity) {
+    if (minCapacity <= store->capacity) {
+        return;
+    }
+    
+    // Every array shares the store's capacity, so each one gets grown from the same starting point
+    Arena *workspace = &blocksCtx->workspace;
+    u32 capacity = store->capacity;
+    ReserveArray(workspace, BlockHandle, store->selfHandles, store->count, capacity, minCapacity);
+    capacity = store->capacity;
+    ReserveArray(workspace, u8, store->types, store->count, capacity, minCapacity);
+    capacity = store->capacity;
+    ReserveArray(workspace, BlockLinks, store->links, store->count, capacity, minCapacity);
+    capacity = store->capacity;
+    ReserveArray(workspace, ScriptHandle, store->scripts, store->count, capacity, minCapacity);
+    capacity = store->capacity;
+    ReserveArray(workspace, BlockInput, store->inputs, store->count, capacity, minCapacity);
+    capacity = store->capacity;
+    ReserveArray(workspace, BlockLayout, store->layouts, store->count, capacity, minCapacity);
+    store->capacity = capacity;
+}
+
+BlockHandle CreateBlock(BlockType type) {
+    BlockStore *store = &blocksCtx->blockStore;
+    ReserveBlocks(store, store->count + 1);
+    
+    u32 slot = store->count++;
+    u32 index = AllocHandleEntry(&store->handles, &blocksCtx->workspace, slot);
+    store->highWaterCount = Max(store->highWaterCount, store->count);
+    
+    store->editsSinceRelocation++;
+    
+    BlockHandle handle = {index, store->handles.entries[index].generation};
+    store->selfHandles[slot] = handle;
+    store->types[slot] = (u8)type;
+    store->links[slot] = {};
+    store->scripts[slot] = {};
+    store->inputs[slot] = {};
+    store->inputs[slot].type = BlockInputType_None;
+    store->layouts[slot] = {};
+    store->layouts[slot].dirty = true; // Hasn't been measured yet
+    return handle;
+}
+
+void ClearBlockInput(BlockInput *input) {
+    if (input->type == BlockInputType_Text && input->text) {
+        ReleaseString(&blocksCtx->strings, input->text);
+    }
+    input->type = BlockInputType_None;
+    input->text = NULL;
+}
+
+void SetBlockInputNumber(BlockHandle handle, f32 number) {
+    BlockInput *input = GetBlockInput(handle);
+    ClearBlockInput(input);
+    input->type = BlockInputType_Number;
+    input->number = number;
+    MarkScriptDirty(GetBlockScript(handle));
+}
+
+void SetBlockInputText(BlockHandle handle, const char *text) {
+    BlockInput *input = GetBlockInput(handle);
+    // Intern the new text first, in case it's the same string we're about to release
+    InternedString *str = InternString(&blocksCtx->strings, text);
+    ClearBlockInput(input);
+    input->type = BlockInputType_Text;
+    input->text = str;
+    MarkScriptDirty(GetBlockScript(handle));
+}
+
+// Releases the block's input payload and its slot. The block must already be unlinked.
+void FreeBlock(BlockHandle handle) {
+    BlockStore *store = &blocksCtx->blockStore;
+    u32 slot = GetBlockSlot(handle);
+    ClearBlockInput(&store->inputs[slot]);
+    FreeHandleEntry(&store->handles, handle.index);
+    
+    // Move the last block into the hole to keep the storage tightly packed
+    u32 lastSlot = --store->count;
+    if (slot != lastSlot) {
+        CopyBlockSlot(store, slot, store, lastSlot);
+        store->handles.entries[store->selfHandles[slot].index].slot = slot;
+        store->editsSinceRelocation++;
+    }
+}
+
+// Frees a block along with everything attached after it, including the inner stacks of branch blocks
+void FreeBlockStack(BlockHandle handle) {
+    while (handle.index) {
+        BlockLinks *links = GetBlockLinks(handle);
+        BlockHandle next = links->next;
+        FreeBlockStack(links->inner);
+        FreeBlock(handle);
+        handle = next;
+    }
+}
+
+Script *GetScript(ScriptHandle handle) {
+    if (!handle.index) {
+        return NULL;
+    }
+    Assert(HandleIsLive(&blocksCtx->scriptHandles, handle.index, handle.generation)); // Stale handle
+    return &blocksCtx->scripts[blocksCtx->scriptHandles.entries[handle.index].slot];
+}
+
+inline
+u32 GetScriptSlot(ScriptHandle handle) {
+    Assert(HandleIsLive(&blocksCtx->scriptHandles, handle.index, handle.generation)); // Stale handle
+    return blocksCtx->scriptHandles.entries[handle.index].slot;
+}
+
+GridCellRange GridCellsForRect(Rectangle rect) {
+    GridCellRange result;
+    result.minX = (s32)Floor(rect.x / SCRIPT_GRID_CELL_SIZE);
+    result.minY = (s32)Floor(rect.y / SCRIPT_GRID_CELL_SIZE);
+    result.maxX = (s32)Floor((rect.x + rect.w) / SCRIPT_GRID_CELL_SIZE);
+    result.maxY = (s32)Floor((rect.y + rect.h) / SCRIPT_GRID_CELL_SIZE);
+    return result;
+}
+
+inline
+u32 HashGridCell(s32 cellX, s32 cellY) {
+    return ((u32)cellX * 73856093u) ^ ((u32)cellY * 19349663u);
+}
+
+inline
+u32 *GridBucketForCell(ScriptGrid *grid, s32 cellX, s32 cellY) {
+    return &grid->buckets[HashGridCell(cellX, cellY) & (grid->bucketCount - 1)];
+}
+
+void InitScriptGrid(ScriptGrid *grid, Arena *arena) {
+    static const u32 INITIAL_BUCKET_COUNT = 1024;
+    
+    *grid = {};
+    grid->bucketCount = INITIAL_BUCKET_COUNT;
+    grid->buckets = PushArray(arena, u32, grid->bucketCount);
+    memset(grid->buckets, 0, sizeof(u32) * grid->bucketCount);
+}
+
+// Doubles the bucket count once there's a node for every bucket, to keep chains short
+void GrowScriptGrid(ScriptGrid *grid) {
+    u32 newBucketCount = grid->bucketCount * 2;
+    u32 *newBuckets = PushArray(&blocksCtx->permanent, u32, newBucketCount);
+    memset(newBuckets, 0, sizeof(u32) * newBucketCount);
+    
+    for (u32 i = 0; i < grid->bucketCount; ++i) {
+        u32 nodeIndex = grid->buckets[i];
+        while (nodeIndex) {
+            ScriptGridNode *node = &grid->nodes[nodeIndex];
+            u32 next = node->nextInBucket;
+            u32 bucketIdx = HashGridCell(node->cellX, node->cellY) & (newBucketCount - 1);
+            node->nextInBucket = newBuckets[bucketIdx];
+            newBuckets[bucketIdx] = nodeIndex;
+            nodeIndex = next;
+        }
+    }
+    
+    // @NOTE: Same as the string table, the old buckets stay in the arena
+    grid->buckets = newBuckets;
+    grid->bucketCount = newBucketCount;
+}
+
+void AddScriptToGrid(ScriptGrid *grid, Script *script) {
+    GridCellRange cells = script->cells;
+    for (s32 cellY = cells.minY; cellY <= cells.maxY; ++cellY) {
+        for (s32 cellX = cells.minX; cellX <= cells.maxX; ++cellX) {
+            u32 nodeIndex = grid->firstFreeNode;
+            if (nodeIndex) {
+                grid->firstFreeNode = grid->nodes[nodeIndex].nextInBucket;
+            }
+            else {
+                if (!grid->nodeCount) {
+                    // Reserve node 0 so that an index of 0 can mean "none"
+                    ReserveArray(&blocksCtx->workspace, ScriptGridNode, grid->nodes, 0, grid->nodeCapacity, 1);
+                    grid->nodeCount = 1;
+                }
+                ReserveArray(&blocksCtx->workspace, ScriptGridNode, grid->nodes, grid->nodeCount, grid->nodeCapacity, grid->nodeCount + 1);
+                nodeIndex = grid->nodeCount++;
+            }
+            
+            u32 *bucket = GridBucketForCell(grid, cellX, cellY);
+            ScriptGridNode *node = &grid->nodes[nodeIndex];
+            node->script = script->handle;
+            node->cellX = cellX;
+            node->cellY = cellY;
+            node->nextInBucket = *bucket;
+            *bucket = nodeIndex;
+            grid->liveNodeCount++;
         }
     }
-    Assert(scriptIdx != -1);
+    script->inGrid = true;
+    
+    if (grid->liveNodeCount > grid->bucketCount) {
+        GrowScriptGrid(grid);
+    }
+}
+
+void RemoveScriptFromGrid(ScriptGrid *grid, Script *script) {
+    if (!script->inGrid) {
+        return;
+    }
+    
+    GridCellRange cells = script->cells;
+    for (s32 cellY = cells.minY; cellY <= cells.maxY; ++cellY) {
+        for (s32 cellX = cells.minX; cellX <= cells.maxX; ++cellX) {
+            u32 *link = GridBucketForCell(grid, cellX, cellY);
+            while (*link) {
+                ScriptGridNode *node = &grid->nodes[*link];
+                if (node->script == script->handle && node->cellX == cellX && node->cellY == cellY) {
+                    u32 nodeIndex = *link;
+                    *link = node->nextInBucket;
+                    node->nextInBucket = grid->firstFreeNode;
+                    grid->firstFreeNode = nodeIndex;
+                    grid->liveNodeCount--;
+                    break;
+                }
+                link = &node->nextInBucket;
+            }
+        }
+    }
+    script->inGrid = false;
+}
+
+// Called with the layout bounds every time a script gets drawn. Only touches the grid if the script crossed into different cells.
+void UpdateScriptBounds(Script *script, Rectangle bounds) {
+    ScriptGrid *grid = &blocksCtx->scriptGrid;
+    GridCellRange cells = GridCellsForRect(bounds);
+    GridCellRange oldCells = script->cells;
+    if (!script->inGrid
+        || cells.minX != oldCells.minX || cells.minY != oldCells.minY
+        || cells.maxX != oldCells.maxX || cells.maxY != oldCells.maxY) {
+        RemoveScriptFromGrid(grid, script);
+        script->cells = cells;
+        AddScriptToGrid(grid, script);
+    }
+    script->bounds = bounds;
+    script->boundsDirty = false;
+}
+
+// Anything that moves a script or changes its shape needs to call this, or the grid won't know where to find it
+void MarkScriptDirty(ScriptHandle handle) {
+    Script *script = GetScript(handle);
+    if (!script) {
+        return;
+    }
+    ReleaseScriptVerts(script);
+    if (script->boundsDirty) {
+        return;
+    }
+    script->boundsDirty = true;
+    ReserveArray(&blocksCtx->workspace, ScriptHandle, blocksCtx->dirtyScripts, blocksCtx->dirtyScriptCount, blocksCtx->dirtyScriptCapacity, blocksCtx->dirtyScriptCount + 1);
+    blocksCtx->dirtyScripts[blocksCtx->dirtyScriptCount++] = handle;
+}
+
+inline
+void AddScriptToDrawList(ScriptDrawList *list, u32 slot) {
+    // A script can turn up more than once (e.g., it spans several cells), but only gets drawn once
+    Script *script = &blocksCtx->scripts[slot];
+    if (script->drawFrame == blocksCtx->frameIndex) {
+        return;
+    }
+    script->drawFrame = blocksCtx->frameIndex;
+    if (list->count == list->capacity) {
+        AlignArena(&blocksCtx->scratch, 16); // Formatted text can leave scratch unaligned
+    }
+    ReserveArray(&blocksCtx->scratch, u32, list->slots, list->count, list->capacity, list->count + 1);
+    list->slots[list->count++] = slot;
+}
+
+// Adds every script whose bounds touch rect
+void AddScriptsInRect(ScriptDrawList *list, Rectangle rect) {
+    ScriptGrid *grid = &blocksCtx->scriptGrid;
+    GridCellRange cells = GridCellsForRect(rect);
+    u64 cellCount = (u64)(cells.maxX - cells.minX + 1) * (u64)(cells.maxY - cells.minY + 1);
+    if (cellCount > blocksCtx->scriptCount) {
+        // Zoomed out far enough that walking the cells costs more than just checking every script
+        for (u32 i = 0; i < blocksCtx->scriptCount; ++i) {
+            Script *script = &blocksCtx->scripts[i];
+            if (script->inGrid && RectsIntersect(script->bounds, rect)) {
+                AddScriptToDrawList(list, i);
+            }
+        }
+        return;
+    }
+    
+    for (s32 cellY = cells.minY; cellY <= cells.maxY; ++cellY) {
+        for (s32 cellX = cells.minX; cellX <= cells.maxX; ++cellX) {
+            u32 nodeIndex = *GridBucketForCell(grid, cellX, cellY);
+            while (nodeIndex) {
+                ScriptGridNode *node = &grid->nodes[nodeIndex];
+                nodeIndex = node->nextInBucket;
+                if (node->cellX != cellX || node->cellY != cellY) {
+                    continue;
+                }
+                
+                u32 slot = GetScriptSlot(node->script);
+                if (RectsIntersect(blocksCtx->scripts[slot].bounds, rect)) {
+                    AddScriptToDrawList(list, slot);
+                }
+            }
+        }
+    }
+}
+
+// Dirty scripts might not be where the grid thinks they are. Measuring them puts them back in the right cells,
+// and only costs as much as whatever changed in them, so the grid can be trusted again before anyone asks it.
+void UpdateDirtyScripts() {
+    for (u32 i = 0; i < blocksCtx->dirtyScriptCount; ++i) {
+        ScriptHandle handle = blocksCtx->dirtyScripts[i];
+        if (!HandleIsLive(&blocksCtx->scriptHandles, handle.index, handle.generation)) {
+            continue;
+        }
+        Script *script = GetScript(handle);
+        UpdateScriptBounds(script, ScriptLayoutBounds(script));
+    }
+    blocksCtx->dirtyScriptCount = 0;
+}
+
+// Sets pickFrame on every script whose bounds contain P. Only those scripts hit test their blocks while drawing.
+void MarkScriptsUnderPoint(v2 P) {
+    ScriptGrid *grid = &blocksCtx->scriptGrid;
+    s32 cellX = (s32)Floor(P.x / SCRIPT_GRID_CELL_SIZE);
+    s32 cellY = (s32)Floor(P.y / SCRIPT_GRID_CELL_SIZE);
+    u32 nodeIndex = *GridBucketForCell(grid, cellX, cellY);
+    while (nodeIndex) {
+        ScriptGridNode *node = &grid->nodes[nodeIndex];
+        nodeIndex = node->nextInBucket;
+        if (node->cellX == cellX && node->cellY == cellY) {
+            Script *script = GetScript(node->script);
+            if (PointInRect(P, script->bounds)) {
+                script->pickFrame = blocksCtx->frameIndex;
+            }
+        }
+    }
+}
+
+// Points every block in the stack starting at block (inner stacks included) at script.
+// Returns the last block in the chain of next links from block.
+BlockHandle SetStackScript(BlockHandle block, ScriptHandle script) {
+    BlockStore *store = &blocksCtx->blockStore;
+    BlockHandle last = {};
+    while (block.index) {
+        u32 slot = GetBlockSlot(block);
+        store->scripts[slot] = script;
+        BlockLinks *links = &store->links[slot];
+        SetStackScript(links->inner, script);
+        last = block;
+        block = links->next;
+    }
+    return last;
+}
+
+void SetScriptTopBlock(ScriptHandle handle, BlockHandle topBlock) {
+    Script *script = GetScript(handle);
+    script->topBlock = topBlock;
+    script->lastBlock = SetStackScript(topBlock, handle);
+    MarkScriptDirty(handle);
+}
+
+ScriptHandle CreateScript(v2 position, BlockHandle topBlock) {
+    ReserveArray(&blocksCtx->workspace, Script, blocksCtx->scripts, blocksCtx->scriptCount, blocksCtx->scriptCapacity, blocksCtx->scriptCount + 1);
+    u32 slot = blocksCtx->scriptCount++;
+    u32 index = AllocHandleEntry(&blocksCtx->scriptHandles, &blocksCtx->workspace, slot);
+    
+    Script *script = &blocksCtx->scripts[slot];
+    *script = { 0 };
+    script->handle.index = index;
+    script->handle.generation = blocksCtx->scriptHandles.entries[index].generation;
+    script->P = position;
+    
+    ScriptHandle handle = script->handle;
+    SetScriptTopBlock(handle, topBlock);
+    return handle;
+}
+
+// Removes the script, but leaves its blocks alone (e.g., they've been merged into another script)
+void DeleteScript(ScriptHandle handle) {
+    HandleTable *handles = &blocksCtx->scriptHandles;
+    Assert(HandleIsLive(handles, handle.index, handle.generation));
+    u32 scriptIdx = handles->entries[handle.index].slot;
+    RemoveScriptFromGrid(&blocksCtx->scriptGrid, &blocksCtx->scripts[scriptIdx]);
+    ReleaseScriptVerts(&blocksCtx->scripts[scriptIdx]);
+    FreeHandleEntry(handles, handle.index);
     
     // Swap the last script into this script's position to keep the array tightly packed
-    if (scriptIdx < blocksCtx->scriptCount - 1) {
-        blocksCtx->scripts[scriptIdx] = blocksCtx->scripts[blocksCtx->scriptCount - 1];
+    u32 lastIdx = blocksCtx->scriptCount - 1;
+    if (scriptIdx < lastIdx) {
+        blocksCtx->scripts[scriptIdx] = blocksCtx->scripts[lastIdx];
+        handles->entries[blocksCtx->scripts[scriptIdx].handle.index].slot = scriptIdx;
     }
     blocksCtx->scriptCount--;
 }
 
-Block *CreateBlock(BlockType type) {
-    Block *block = PushStruct(&blocksCtx->permanent, Block);
-    *block = { 0 };
-    block->type = type;
-    block->inputType = BlockInputType_None;
-    return block;
+// Deletes a script along with all of its blocks
+void DestroyScript(ScriptHandle handle) {
+    FreeBlockStack(GetScript(handle)->topBlock);
+    DeleteScript(handle);
+}
+
+struct WorkspaceArray {
+    void **data;
+    umm elementSize;
+    u32 count;
+    u32 *capacity;
+};
+
+#define MAX_WORKSPACE_ARRAYS 24
+
+// Every array that lives in the workspace arena. Anything added to the workspace needs to be listed here.
+u32 GetWorkspaceArrays(WorkspaceArray *arrays) {
+    BlockStore *store = &blocksCtx->blockStore;
+    HandleTable *scriptHandles = &blocksCtx->scriptHandles;
+    ScriptGrid *grid = &blocksCtx->scriptGrid;
+    SnapIndex *snap = &blocksCtx->snapIndex;
+    QuadIndexBuffer *quadIndices = &blocksCtx->quadIndices;
+    u32 arrayCount = 0;
+    arrays[arrayCount++] = {(void **)&store->selfHandles, sizeof(BlockHandle), store->count, &store->capacity};
+    arrays[arrayCount++] = {(void **)&store->types, sizeof(u8), store->count, &store->capacity};
+    arrays[arrayCount++] = {(void **)&store->links, sizeof(BlockLinks), store->count, &store->capacity};
+    arrays[arrayCount++] = {(void **)&store->scripts, sizeof(ScriptHandle), store->count, &store->capacity};
+    arrays[arrayCount++] = {(void **)&store->inputs, sizeof(BlockInput), store->count, &store->capacity};
+    arrays[arrayCount++] = {(void **)&store->layouts, sizeof(BlockLayout), store->count, &store->capacity};
+    arrays[arrayCount++] = {(void **)&store->handles.entries, sizeof(HandleEntry), store->handles.count, &store->handles.capacity};
+    arrays[arrayCount++] = {(void **)&scriptHandles->entries, sizeof(HandleEntry), scriptHandles->count, &scriptHandles->capacity};
+    arrays[arrayCount++] = {(void **)&blocksCtx->scripts, sizeof(Script), blocksCtx->scriptCount, &blocksCtx->scriptCapacity};
+    arrays[arrayCount++] = {(void **)&grid->nodes, sizeof(ScriptGridNode), grid->nodeCount, &grid->nodeCapacity};
+    arrays[arrayCount++] = {(void **)&blocksCtx->dirtyScripts, sizeof(ScriptHandle), blocksCtx->dirtyScriptCount, &blocksCtx->dirtyScriptCapacity};
+    arrays[arrayCount++] = {(void **)&blocksCtx->vertexCache.data, sizeof(u8), blocksCtx->vertexCache.used, &blocksCtx->vertexCache.capacity};
+    arrays[arrayCount++] = {(void **)&quadIndices->data, sizeof(u8), quadIndices->quadCount * 6 * quadIndices->indexSize, &quadIndices->capacity};
+    arrays[arrayCount++] = {(void **)&snap->candidates, sizeof(SnapCandidate), snap->candidateCount, &snap->candidateCapacity};
+    arrays[arrayCount++] = {(void **)&snap->entries, sizeof(SnapCellEntry), snap->entryCount, &snap->entryCapacity};
+    arrays[arrayCount++] = {(void **)&snap->buckets, sizeof(u32), snap->bucketCount, &snap->bucketCapacity};
+    Assert(arrayCount <= MAX_WORKSPACE_ARRAYS);
+    return arrayCount;
+}
+
+#define MIN_WORKSPACE_COMPACTION_SIZE Kilobytes(64)
+
+u32 CompactedCapacity(WorkspaceArray array) {
+    // Leave some headroom so we don't immediately have to grow again. Capacities stay multiples of 16,
+    // like the ones ReserveArray() hands out, so arrays of small elements don't knock the next one out of alignment.
+    u32 result = array.count + (array.count / 2);
+    result = (u32)AlignDown(result + 15, 16);
+    result = Max(result, 16u);
+    return Min(result, *array.capacity);
+}
+
+// True once compacting would give back at least half of the workspace
+b32 WorkspaceNeedsCompaction() {
+    Arena *workspace = &blocksCtx->workspace;
+    umm used = ArenaTotalUsed(workspace);
+    if (used < MIN_WORKSPACE_COMPACTION_SIZE) {
+        return false;
+    }
+    
+    WorkspaceArray arrays[MAX_WORKSPACE_ARRAYS];
+    u32 arrayCount = GetWorkspaceArrays(arrays);
+    umm compactedSize = 0;
+    for (u32 i = 0; i < arrayCount; ++i) {
+        compactedSize += arrays[i].elementSize * CompactedCapacity(arrays[i]);
+    }
+    return compactedSize < used / 2;
+}
+
+// Moves the live workspace arrays down to the bottom of the arena, trimmed to a little more than they're
+// using, and releases everything they outgrew. Handles stay valid. Block and Script pointers don't.
+void CompactWorkspace() {
+    Arena *workspace = &blocksCtx->workspace;
+    WorkspaceArray arrays[MAX_WORKSPACE_ARRAYS];
+    u32 arrayCount = GetWorkspaceArrays(arrays);
+    
+    if (!workspace->chunk) {
+        // Everything is in the arena's original memory, so slide the arrays down in address order.
+        // An array's new location never starts past its old one, so memmove takes care of any overlap.
+        for (u32 i = 1; i < arrayCount; ++i) {
+            WorkspaceArray array = arrays[i];
+            u32 j = i;
+            for (; j > 0 && (umm)*arrays[j - 1].data > (umm)*array.data; --j) {
+                arrays[j] = arrays[j - 1];
+            }
+            arrays[j] = array;
+        }
+        
+        UpdateArenaHighWater(workspace);
+        workspace->used = 0;
+        for (u32 i = 0; i < arrayCount; ++i) {
+            WorkspaceArray array = arrays[i];
+            if (!*array.data) {
+                continue;
+            }
+            u32 capacity = CompactedCapacity(array);
+            void *newData = PushSize(workspace, array.elementSize * capacity);
+            memmove(newData, *array.data, array.elementSize * array.count);
+            *array.data = newData;
+            *array.capacity = capacity;
+        }
+    }
+    else {
+        // The arrays are spread across chunks, so stage them in scratch, then start the arena over
+        TempMemory temp = BeginTempMemory(&blocksCtx->scratch);
+        void *staged[MAX_WORKSPACE_ARRAYS];
+        for (u32 i = 0; i < arrayCount; ++i) {
+            WorkspaceArray array = arrays[i];
+            staged[i] = PushSize(&blocksCtx->scratch, array.elementSize * array.count);
+            memcpy(staged[i], *array.data, array.elementSize * array.count);
+        }
+        
+        FreeArenaChunks(workspace);
+        for (u32 i = 0; i < arrayCount; ++i) {
+            WorkspaceArray array = arrays[i];
+            if (!*array.data) {
+                continue;
+            }
+            u32 capacity = CompactedCapacity(array);
+            *array.data = PushSize(workspace, array.elementSize * capacity);
+            memcpy(*array.data, staged[i], array.elementSize * array.count);
+            *array.capacity = capacity;
+        }
+        EndTempMemory(temp);
+    }
+}
+
+// Copies a stack into dest in the same order DrawSubScript() visits it (each block, then its inner
+// stack, then the block after it), pointing each block's handle at its new slot as it goes
+void CopyStackInTraversalOrder(BlockStore *store, BlockHandle handle, BlockStore *dest) {
+    while (handle.index) {
+        // Blocks we haven't copied yet still resolve into the old arrays, which stay untouched until we're done
+        u32 srcSlot = GetBlockSlot(handle);
+        u32 destSlot = dest->count++;
+        CopyBlockSlot(dest, destSlot, store, srcSlot);
+        store->handles.entries[handle.index].slot = destSlot;
+        
+        BlockLinks *links = &store->links[srcSlot];
+        CopyStackInTraversalOrder(store, links->inner, dest);
+        handle = links->next;
+    }
+}
+
+// See RELOCATION_MIN_EDITS
+b32 BlocksNeedRelocation() {
+    BlockStore *store = &blocksCtx->blockStore;
+    u32 minEdits = Max((u32)RELOCATION_MIN_EDITS, store->count / RELOCATION_EDIT_FRACTION);
+    return store->editsSinceRelocation >= minEdits && blocksCtx->idleFrameCount >= RELOCATION_IDLE_FRAMES;
+}
+
+// Lays every script's blocks out contiguously, in the order they get rendered, so that walking a stack
+// each frame reads memory front to back instead of jumping around in creation order.
+// The old arrays are left behind in the workspace for CompactWorkspace() to reclaim.
+void RelocateBlocksInTraversalOrder() {
+    BlockStore *store = &blocksCtx->blockStore;
+    Arena *workspace = &blocksCtx->workspace;
+    if (!store->count) {
+        store->editsSinceRelocation = 0;
+        return;
+    }
+    umm blockSize = sizeof(BlockHandle) + sizeof(u8) + sizeof(BlockLinks) + sizeof(ScriptHandle) + sizeof(BlockInput) + sizeof(BlockLayout);
+    if (!workspace->allocator && workspace->used + (blockSize * store->capacity) > workspace->size) {
+        // No room for a second copy. Leave things as they are until compaction frees some up.
+        return;
+    }
+    
+    BlockStore ordered = {};
+    ordered.selfHandles = PushArray(workspace, BlockHandle, store->capacity);
+    ordered.types = PushArray(workspace, u8, store->capacity);
+    ordered.links = PushArray(workspace, BlockLinks, store->capacity);
+    ordered.scripts = PushArray(workspace, ScriptHandle, store->capacity);
+    ordered.inputs = PushArray(workspace, BlockInput, store->capacity);
+    ordered.layouts = PushArray(workspace, BlockLayout, store->capacity);
+    for (u32 i = 0; i < blocksCtx->scriptCount; ++i) {
+        CopyStackInTraversalOrder(store, blocksCtx->scripts[i].topBlock, &ordered);
+    }
+    Assert(ordered.count == store->count); // Every block should belong to exactly one script
+    
+    store->selfHandles = ordered.selfHandles;
+    store->types = ordered.types;
+    store->links = ordered.links;
+    store->scripts = ordered.scripts;
+    store->inputs = ordered.inputs;
+    store->layouts = ordered.layouts;
+    store->editsSinceRelocation = 0;
 }
 
 inline
@@ -104,67 +844,115 @@ b32 HasInnerOutlet(BlockType type) {
     return true; // I guess? Since most block do have an outlet?
 }
 
+// Call on a block whose size (or whose chain of next links) just changed. The blocks before it in its stack and
+// the branch blocks it's nested inside all get measured again, on the way up to the script's top block.
+// Anything already dirty has had its own way up marked already, so the walk can stop there.
+void MarkBlockLayoutDirty(BlockHandle block) {
+    BlockStore *store = &blocksCtx->blockStore;
+    while (block.index) {
+        u32 slot = GetBlockSlot(block);
+        if (store->layouts[slot].dirty) {
+            break;
+        }
+        store->layouts[slot].dirty = true;
+        BlockLinks *links = &store->links[slot];
+        block = links->prev.index ? links->prev : links->parent;
+    }
+}
+
+// Linking blocks keeps each block's script and each script's lastBlock up to date as it goes.
+// Whatever gets attached joins the script of the block it's attached to.
 inline
-void Connect(Block *from, Block *to) {
-    Assert(HasOutlet(from->type));
-    Assert(HasInlet(to->type));
-    from->next = to;
-    to->prev = from;
+void Connect(BlockHandle from, BlockHandle to) {
+    Assert(HasOutlet(GetBlockType(from)));
+    Assert(HasInlet(GetBlockType(to)));
+    GetBlockLinks(from)->next = to;
+    GetBlockLinks(to)->prev = from;
+    
+    Script *script = GetScript(GetBlockScript(from));
+    BlockHandle last = SetStackScript(to, GetBlockScript(from));
+    if (script && script->lastBlock == from) {
+        script->lastBlock = last;
+    }
+    MarkBlockLayoutDirty(from);
+    MarkScriptDirty(GetBlockScript(from));
+    blocksCtx->blockStore.editsSinceRelocation++;
 }
 
+// Returns the last block in the chain of next links from to
 inline
-void ConnectInner(Block *from, Block *to) {
-    Assert(HasInnerOutlet(from->type));
-    Assert(HasInlet(to->type));
-    from->inner = to;
-    to->parent = from;
+BlockHandle ConnectInner(BlockHandle from, BlockHandle to) {
+    Assert(HasInnerOutlet(GetBlockType(from)));
+    Assert(HasInlet(GetBlockType(to)));
+    GetBlockLinks(from)->inner = to;
+    GetBlockLinks(to)->parent = from;
+    
+    BlockHandle last = SetStackScript(to, GetBlockScript(from));
+    MarkBlockLayoutDirty(from);
+    MarkScriptDirty(GetBlockScript(from));
+    blocksCtx->blockStore.editsSinceRelocation++;
+    return last;
 }
 
-// Call this on the block to disconnect from its previous
+// Call this on the block to disconnect from its previous. last is the end of the chain of next links from block,
+// which the caller gets back from moving the chain (see SetStackScript()), so it isn't walked again here.
+// Callers move the blocks first, and any that they leave alone keep their old script until they're given a new one.
 inline
-void Disconnect(Block *block) {
-    Assert(block->prev);
-    block->prev->next = NULL;
-    block->prev = NULL;
+void Disconnect(BlockHandle block, BlockHandle last) {
+    BlockLinks *links = GetBlockLinks(block);
+    BlockHandle prev = links->prev;
+    Assert(prev.index);
+    GetBlockLinks(prev)->next = {};
+    links->prev = {};
+    
+    ScriptHandle scriptHandle = GetBlockScript(prev);
+    Script *script = GetScript(scriptHandle);
+    if (script && script->lastBlock == last) {
+        script->lastBlock = prev;
+    }
+    MarkBlockLayoutDirty(prev); // The blocks we took are the same shape they were
+    MarkScriptDirty(scriptHandle);
+    blocksCtx->blockStore.editsSinceRelocation++;
 }
 
 // Call this on the block to disconnect from its parent
 inline
-void DisconnectInner(Block *block) {
-    Assert(block->parent);
-    block->parent->inner = NULL;
-    block->parent = NULL;
+void DisconnectInner(BlockHandle block) {
+    BlockLinks *links = GetBlockLinks(block);
+    BlockHandle parent = links->parent;
+    Assert(parent.index);
+    GetBlockLinks(parent)->inner = {};
+    links->parent = {};
+    MarkBlockLayoutDirty(parent);
+    MarkScriptDirty(GetBlockScript(block));
+    blocksCtx->blockStore.editsSinceRelocation++;
 }
 
-Script *TearOff(Block *block, v2 position) {
-    Assert(block->prev || block->parent);
-    Script *script = CreateScript(position);
-    if (block->prev) {
-        block->prev->next = NULL;
-        block->prev = NULL;
+ScriptHandle TearOff(BlockHandle block, v2 position) {
+    BlockLinks *links = GetBlockLinks(block);
+    Assert(links->prev.index || links->parent.index);
+    if (links->parent.index) {
+        DisconnectInner(block);
+        return CreateScript(position, block);
     }
-    else if (block->parent) {
-        block->parent->inner = NULL;
-        block->parent = NULL;
-    }
-    script->topBlock = block;
+    // Giving the blocks their new script finds the end of them, which Disconnect() needs
+    ScriptHandle script = CreateScript(position, block);
+    Disconnect(block, GetScript(script)->lastBlock);
     return script;
 }
 
+// Every block belongs to a script, so anything that isn't attached to another block must be on top
 inline
-b32 IsTopBlock(Block *block) {
-    // Simple linear search
-    for (u32 i = 0; i < blocksCtx->scriptCount; ++i) {
-        if (blocksCtx->scripts[i].topBlock == block) {
-            return true;
-        }
-    }
-    return false;
+b32 IsTopBlock(BlockHandle block) {
+    BlockLinks *links = GetBlockLinks(block);
+    b32 result = !links->prev.index && !links->parent.index;
+    Assert(!result || GetScript(GetBlockScript(block))->topBlock == block);
+    return result;
 }
 
 inline
-b32 IsTopBlockOfScript(Block *block, Script *script) {
-    Assert(block && script);
+b32 IsTopBlockOfScript(BlockHandle block, Script *script) {
+    Assert(block.index && script);
     return (script->topBlock == block);
 }
 
@@ -188,6 +976,70 @@ b32 IsBranchBlockType(BlockType type) {
     return type == BlockType_Loop || type == BlockType_Forever;
 }
 
+// Brings the cached layout of the stack starting at block up to date, and returns the size of the stack.
+// Only what MarkBlockLayoutDirty() marked gets measured. Everything else is taken from the cache.
+v2 UpdateStackLayout(BlockHandle block) {
+    if (!block.index) {
+        return v2{0, 0};
+    }
+    Assert(!GetBlockLinks(block)->prev.index);
+    
+    BlockStore *store = &blocksCtx->blockStore;
+    BlockLayout *layout = &store->layouts[GetBlockSlot(block)];
+    if (!layout->dirty) {
+        return layout->stackSize;
+    }
+    
+    // Dirty blocks always come at the front of a stack, since the blocks before a dirty one are marked along with it.
+    // Measure each of them, then add the sizes up back to front, starting from wherever the clean blocks begin.
+    BlockHandle last = {};
+    v2 restSize = {0, 0};
+    while (block.index) {
+        u32 slot = GetBlockSlot(block);
+        layout = &store->layouts[slot];
+        if (!layout->dirty) {
+            restSize = layout->stackSize;
+            break;
+        }
+        
+        BlockType type = (BlockType)store->types[slot];
+        BlockMetrics *metrics = &METRICS[type];
+        layout->size = metrics->size;
+        if (IsBranchBlockType(type)) {
+            v2 innerSize = UpdateStackLayout(store->links[slot].inner);
+            layout = &store->layouts[slot];
+            u32 horizStretch = Max(innerSize.w - metrics->innerSize.w, 0);
+            u32 vertStretch = Max(innerSize.h - metrics->innerSize.h, 0);
+            layout->size.w += horizStretch;
+            layout->size.h += vertStretch;
+        }
+        
+        last = block;
+        block = store->links[slot].next;
+    }
+    
+    block = last;
+    while (true) {
+        u32 slot = GetBlockSlot(block);
+        layout = &store->layouts[slot];
+        restSize = v2{layout->size.w + restSize.w, Max(layout->size.h, restSize.h)};
+        layout->stackSize = restSize;
+        layout->dirty = false;
+        if (!store->links[slot].prev.index || !store->layouts[GetBlockSlot(store->links[slot].prev)].dirty) {
+            break;
+        }
+        block = store->links[slot].prev;
+    }
+    
+    return restSize;
+}
+
+// Where the script's blocks cover, going by the layout cache
+Rectangle ScriptLayoutBounds(Script *script) {
+    v2 size = UpdateStackLayout(script->topBlock);
+    return Rectangle{script->P.x, script->P.y, size.w, size.h};
+}
+
 inline
 Layout CreateEmptyLayoutAt(v2 at) {
     return {at, Rectangle{at.x, at.y, 0, 0}};
@@ -208,174 +1060,851 @@ RenderEntryType RenderEntryTypeForBlockType(BlockType blockType) {
         case BlockType_Forever: return RenderEntryType_Forever;
         default: break;
     }
-    return RenderEntryType_Null;
+    return RenderEntryType_Null;
+}
+
+inline
+RenderEntryType RenderEntryTypeForBlockInputType(BlockInputType type) {
+    switch (type) {
+        case BlockInputType_Number: return RenderEntryType_InputNumber;
+        case BlockInputType_Text:   return RenderEntryType_InputText;
+        default: break;
+    }
+    return RenderEntryType_Null;
+}
+
+
+inline
+v4 ColorForBlockType(BlockType blockType) {
+    switch (blockType) {
+        case BlockType_Command: return SCRATCH_COLORS[SCRATCH_COLOR_MOTION_1];
+        case BlockType_Event:   return SCRATCH_COLORS[SCRATCH_COLOR_EVENTS_1];
+        case BlockType_EndCap:  return SCRATCH_COLORS[SCRATCH_COLOR_LOOKS_1];
+        case BlockType_Loop:    return SCRATCH_COLORS[SCRATCH_COLOR_CONTROL_1];
+        case BlockType_Forever: return SCRATCH_COLORS[SCRATCH_COLOR_SOUNDS_1];
+        default: {
+            Invalid;
+            break;
+        }
+    }
+    return v4{1, 1, 1, 1};
+}
+
+inline
+v4 OutlineColorForBlockType(BlockType blockType) {
+    switch (blockType) {
+        case BlockType_Command: return SCRATCH_COLORS[SCRATCH_COLOR_MOTION_2];
+        case BlockType_Event:   return SCRATCH_COLORS[SCRATCH_COLOR_EVENTS_2];
+        case BlockType_EndCap:  return SCRATCH_COLORS[SCRATCH_COLOR_LOOKS_2];
+        case BlockType_Loop:    return SCRATCH_COLORS[SCRATCH_COLOR_CONTROL_2];
+        case BlockType_Forever: return SCRATCH_COLORS[SCRATCH_COLOR_SOUNDS_2];
+        default: {
+            Invalid;
+            break;
+        }
+    }
+    return v4{1, 1, 1, 1};
+}
+
+v2 UnprojectMouse(v2 mouseP, RenderGroup *group) {
+    f32 projectedX = (((2.0 * mouseP.x) / blocksCtx->screenSize.w) - 1.0);
+    f32 projectedY = (((2.0 * mouseP.y) / blocksCtx->screenSize.h) - 1.0);
+    
+    mat4x4 unprojection = group->invTransform;
+    v4 unprojectedP = unprojection * v4{projectedX, projectedY, 0, 1};
+    return unprojectedP.xy;
+}
+
+#define CULL_MARGIN 8.0f // Inputs and connectors stick out past a block's size, and text can overflow its input
+
+void InitRenderGroup(RenderGroup *group, RenderLayer layer, mat4x4 transform, mat4x4 invTransform) {
+    group->highWaterCount = Max(group->highWaterCount, group->entryCount);
+    group->firstChunk = 0;
+    group->lastChunk = 0;
+    group->entryCount = 0;
+    group->reservedCount = 0;
+    group->captures = 0;
+    group->captureCount = 0;
+    group->captureCapacity = 0;
+    group->layer = layer;
+    group->transform = transform;
+    group->invTransform = invTransform;
+    group->mouseP = UnprojectMouse(blocksCtx->input.mouseP, group);
+    
+    // Unproject the corners of clip space to get the part of the group's coordinate space that ends up on screen
+    v2 cornerA = (invTransform * v4{-1, -1, 0, 1}).xy;
+    v2 cornerB = (invTransform * v4{1, 1, 0, 1}).xy;
+    v2 minP = { Min(cornerA.x, cornerB.x), Min(cornerA.y, cornerB.y) };
+    v2 maxP = { Max(cornerA.x, cornerB.x), Max(cornerA.y, cornerB.y) };
+    Rectangle visible = { minP.x, minP.y, maxP.x - minP.x, maxP.y - minP.y };
+    group->cullBounds = InflateRectangle(visible, CULL_MARGIN);
+}
+
+void ReleaseScriptVerts(Script *script) {
+    VertexSpan *span = &script->cachedVerts;
+    if (span->valid) {
+        blocksCtx->vertexCache.garbage += span->size;
+        span->valid = false;
+    }
+}
+
+// Keeps the vertices a script was just drawn with, so later frames can reuse them
+void CaptureScriptVerts(ScriptHandle handle, u8 *verts, u32 size) {
+    if (!HandleIsLive(&blocksCtx->scriptHandles, handle.index, handle.generation)) {
+        return;
+    }
+    Script *script = GetScript(handle);
+    if (script->boundsDirty) {
+        // Changed after it was drawn, so these are out of date already
+        return;
+    }
+    
+    VertexCache *cache = &blocksCtx->vertexCache;
+    Arena *workspace = &blocksCtx->workspace;
+    if (!workspace->allocator && cache->used + size > cache->capacity
+        && workspace->used + 2 * ((umm)cache->used + size) > workspace->size) {
+        // No room to grow. The script just gets drawn the normal way until compaction frees some up.
+        return;
+    }
+    ReserveArray(workspace, u8, cache->data, cache->used, cache->capacity, cache->used + size);
+    memcpy(cache->data + cache->used, verts, size);
+    
+    VertexSpan *span = &script->cachedVerts;
+    if (span->valid) {
+        cache->garbage += span->size;
+    }
+    span->offset = cache->used;
+    span->size = size;
+    span->valid = true;
+    cache->used += size;
+}
+
+// Call with the key of every entry while assembling a group, in sorted order, and with the first key of the
+// next layer after the last entry of each layer
+inline
+void StepVertexCaptures(Arena *vertexArena, RenderGroup *group, u32 sortKey) {
+    while (group->nextCapture < group->captureCount) {
+        VertexCapture *capture = &group->captures[group->nextCapture];
+        if (capture->firstKey == sortKey) {
+            group->captureStart = ContiguousRegionSize(vertexArena);
+        }
+        if (capture->endKey > sortKey) {
+            break;
+        }
+        umm captureSize = ContiguousRegionSize(vertexArena) - group->captureStart;
+        CaptureScriptVerts(capture->script, vertexArena->contiguousStart + group->captureStart, (u32)captureSize);
+        group->nextCapture++;
+    }
+}
+
+b32 VertexCacheNeedsRepack() {
+    VertexCache *cache = &blocksCtx->vertexCache;
+    return cache->garbage >= VERTEX_CACHE_MIN_REPACK_SIZE && cache->garbage > cache->used / 2;
+}
+
+// Copies the spans still in use into a new array, leaving the old one behind in the workspace for
+// CompactWorkspace() to reclaim. Scripts that haven't been drawn in a while lose their spans here too.
+void RepackVertexCache() {
+    VertexCache *cache = &blocksCtx->vertexCache;
+    u32 liveSize = 0;
+    for (u32 i = 0; i < blocksCtx->scriptCount; ++i) {
+        Script *script = &blocksCtx->scripts[i];
+        if (blocksCtx->frameIndex - script->drawFrame > VERTEX_CACHE_MAX_IDLE_FRAMES) {
+            ReleaseScriptVerts(script);
+        }
+        if (script->cachedVerts.valid) {
+            liveSize += script->cachedVerts.size;
+        }
+    }
+    
+    Arena *workspace = &blocksCtx->workspace;
+    if (!workspace->allocator && workspace->used + 2 * (umm)liveSize > workspace->size) {
+        return;
+    }
+    
+    VertexCache repacked = {};
+    ReserveArray(workspace, u8, repacked.data, 0, repacked.capacity, liveSize);
+    for (u32 i = 0; i < blocksCtx->scriptCount; ++i) {
+        Script *script = &blocksCtx->scripts[i];
+        VertexSpan *span = &script->cachedVerts;
+        if (span->valid) {
+            memcpy(repacked.data + repacked.used, cache->data + span->offset, span->size);
+            span->offset = repacked.used;
+            repacked.used += span->size;
+        }
+    }
+    *cache = repacked;
+}
+
+// Only command blocks get drawn at other scales
+inline
+f32 BlockTemplateScale(RenderEntry *entry) {
+    return (entry->type == RenderEntryType_Command) ? entry->scale : 1.0f;
+}
+
+// The vertex tables that block templates get built from. Everything else goes through PushEntryVerts().
+void PushBlockTableVerts(Arena *vertexArena, RenderEntry *entry) {
+    Assert(HasBlockTemplate(entry->type));
+    switch(entry->type) {
+        case RenderEntryType_Command: {
+            PushCommandBlockVerts(vertexArena, entry->P, entry->color, entry->outline, entry->scale);
+            break;
+        }
+        case RenderEntryType_Event: {
+            PushEventBlockVerts(vertexArena, entry->P, entry->color, entry->outline);
+            break;
+        }
+        case RenderEntryType_EndCap: {
+            PushEndCapBlockVerts(vertexArena, entry->P, entry->color, entry->outline);
+            break;
+        }
+        case RenderEntryType_Loop: {
+            PushLoopBlockVerts(vertexArena, entry->P, entry->color, entry->outline, entry->hStretch, entry->vStretch);
+            break;
+        }
+        case RenderEntryType_Forever: {
+            PushForeverBlockVerts(vertexArena, entry->P, entry->color, entry->outline, entry->hStretch, entry->vStretch);
+            break;
+        }
+        case RenderEntryType_InputNumber: {
+            PushNumberInputVerts(vertexArena, entry->P, entry->color, entry->outline);
+            break;
+        }
+        case RenderEntryType_InputText: {
+            PushTextInputVerts(vertexArena, entry->P, entry->color, entry->outline);
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+void PushEntryVerts(Arena *vertexArena, RenderEntry *entry) {
+    switch(entry->type) {
+        case RenderEntryType_Command:
+        case RenderEntryType_Event:
+        case RenderEntryType_EndCap:
+        case RenderEntryType_Loop:
+        case RenderEntryType_Forever:
+        case RenderEntryType_InputNumber:
+        case RenderEntryType_InputText: {
+            PushTemplateVerts(vertexArena, &blocksCtx->blockTemplates, entry->type, 
+                              entry->P, v2{(f32)entry->hStretch, (f32)entry->vStretch}, BlockTemplateScale(entry), 
+                              entry->color, entry->outline);
+            break;
+        }
+        case RenderEntryType_Rect: {
+            PushSolidRect(vertexArena, entry->rect, entry->color);
+            break;
+        }
+        case RenderEntryType_RectOutline: {
+            PushRectOutline(vertexArena, entry->rect, entry->color, entry->outline);
+            break;
+        }
+        case RenderEntryType_Text: {
+            PushFontString(vertexArena, entry->text, entry->P, entry->textHeight, entry->color, entry->outline);
+            break;
+        }
+        case RenderEntryType_CachedVerts: {
+            PushData_(vertexArena, blocksCtx->vertexCache.data + entry->span.offset, entry->span.size);
+            break;
+        }
+        case RenderEntryType_Null: {
+            // No-op
+            // @TODO: Assert? Warning? Nothing?
+            break;
+        }
+    }
+}
+
+// Puts the group's entries in sortKey order. They were pushed in index order, so only the layers need sorting.
+void SortRenderGroup(RenderGroup *group, Arena *tempArena) {
+    u32 count = group->entryCount;
+    
+    AlignArena(tempArena, 16);
+    group->sortedEntries = PushArray(tempArena, RenderEntry *, count);
+    memset(group->layerStarts, 0, sizeof(group->layerStarts));
+    group->nextCapture = 0;
+    group->captureStart = 0;
+    
+    TempMemory temp = BeginTempMemory(tempArena);
+    RenderEntry **entries = PushArray(tempArena, RenderEntry *, count);
+    u32 *keys = PushArray(tempArena, u32, count);
+    u32 entryIndex = 0;
+    for (RenderEntryChunk *chunk = group->firstChunk; chunk; chunk = chunk->next) {
+        for (u32 entryIdx = 0; entryIdx < chunk->count; ++entryIdx) {
+            RenderEntry *entry = &chunk->entries[entryIdx];
+            entries[entryIndex] = entry;
+            keys[entryIndex] = entry->sortKey;
+            entryIndex++;
+        }
+    }
+    Assert(entryIndex == count);
+    
+    RadixSort(keys, count, tempArena, RENDER_LAYER_SHIFT);
+    for (u32 i = 0; i < count; ++i) {
+        group->sortedEntries[i] = entries[keys[i] & RENDER_ENTRY_INDEX_MASK];
+        group->layerStarts[(keys[i] >> RENDER_LAYER_SHIFT) + 1]++;
+    }
+    for (u32 layer = 0; layer < RenderLayerCount; ++layer) {
+        group->layerStarts[layer + 1] += group->layerStarts[layer];
+    }
+    EndTempMemory(temp);
+}
+
+// Assembles a segment of a sorted group onto the end of the contiguous vertex region
+void AssembleVertexBuferForRenderGroup(Arena *vertexArena, DrawSegment *segment) {
+    RenderGroup *renderGroup = segment->group;
+    for (u32 i = segment->firstEntry; i < segment->endEntry; ++i) {
+        RenderEntry *entry = renderGroup->sortedEntries[i];
+        StepVertexCaptures(vertexArena, renderGroup, entry->sortKey);
+#ifdef BLOCKS_INSTANCED_BLOCKS
+        if (IsInstancedEntryType(entry->type)) {
+            continue;
+        }
+#endif
+        PushEntryVerts(vertexArena, entry);
+        
+        #if 0
+        // Draw inlet, outlet, and innerOutlet hit-boxes
+        if (entry->block.index) {
+            BlockType type = GetBlockType(entry->block);
+            BlockMetrics *metrics = &METRICS[type];
+            if (HasInlet(type)) {
+                Rectangle inletRect = {entry->P.x + metrics->inlet.origin.x, 
+                                       entry->P.y + metrics->inlet.origin.y,
+                                       metrics->inlet.size.w,
+                                       metrics->inlet.size.h};
+                DEBUGPushRectOutline(inletRect, v4{0, 1, 1, 1});
+            }
+            if (HasOutlet(type)) {
+                if (IsBranchBlockType(type)) {
+                    Rectangle outletRect = {entry->P.x + metrics->outlet.origin.x + entry->hStretch, 
+                                            entry->P.y + metrics->outlet.origin.y,
+                                            metrics->outlet.size.w,
+                                            metrics->outlet.size.h};
+                    DEBUGPushRectOutline(outletRect, v4{1, 0, 1, 1});
+                }
+                else {
+                    Rectangle outletRect = {entry->P.x + metrics->outlet.origin.x, 
+                                            entry->P.y + metrics->outlet.origin.y,
+                                            metrics->outlet.size.w,
+                                            metrics->outlet.size.h};
+                    DEBUGPushRectOutline(outletRect, v4{1, 0, 1, 1});
+                }
+            }
+            if (HasInnerOutlet(type)) {
+                Rectangle innerOutletRect = {entry->P.x + metrics->innerOutlet.origin.x, 
+                                             entry->P.y + metrics->innerOutlet.origin.y,
+                                             metrics->innerOutlet.size.w,
+                                             metrics->innerOutlet.size.h};
+                DEBUGPushRectOutline(innerOutletRect, v4{1, 1, 0, 1});
+            }
+        }
+        #endif
+        
+    }
+    if (segment->endEntry == renderGroup->layerStarts[segment->layer + 1]) {
+        StepVertexCaptures(vertexArena, renderGroup, (u32)(segment->layer + 1) << RENDER_LAYER_SHIFT);
+    }
+}
+
+#ifdef BLOCKS_INSTANCED_BLOCKS
+inline
+void PushInstance(Arena *instanceArena, RenderEntry *entry, u32 templateIndex, v2 P, v2 stretch, f32 scale) {
+    BlocksInstance *instance = PushStruct(instanceArena, BlocksInstance);
+    instance->P = P;
+    instance->stretch = stretch;
+    instance->scale = scale;
+    instance->templateIndex = templateIndex;
+#ifdef BLOCKS_COMPACT_VERTICES
+    PackRGBA8(instance->color, entry->color);
+    PackRGBA8(instance->outline, entry->outline);
+#else
+    instance->color = entry->color;
+    instance->outline = entry->outline;
+#endif
+}
+
+// Second pass over a segment of a sorted group, after the vertices have been assembled
+void AssembleInstanceBufferForRenderGroup(Arena *instanceArena, DrawSegment *segment) {
+    for (u32 i = segment->firstEntry; i < segment->endEntry; ++i) {
+        RenderEntry *entry = segment->group->sortedEntries[i];
+        if (entry->type == RenderEntryType_Text) {
+            // Glyph templates are unit quads offset from the pen, so each character's size goes in its stretch
+            f32 fontScale = ScaleForFontHeight(entry->textHeight);
+            v2 at = entry->P;
+            for (u32 c = 0; entry->text[c]; ++c) {
+                Assert((u32)entry->text[c] < GLYPH_TEMPLATE_COUNT);
+                SdfFontChar character = FONT_DATA[entry->text[c]];
+                v2 size = v2{(f32)character.w * fontScale, (f32)character.h * fontScale};
+                PushInstance(instanceArena, entry, BLOCK_TEMPLATE_COUNT + entry->text[c], at, size, fontScale);
+                AdvanceFontString(entry->text, c, fontScale, &at.x);
+            }
+        }
+        else if (HasBlockTemplate(entry->type)) {
+            v2 stretch = v2{(f32)entry->hStretch, (f32)entry->vStretch};
+            PushInstance(instanceArena, entry, entry->type, entry->P, stretch, BlockTemplateScale(entry));
+        }
+    }
+}
+#endif
+
+// Everything shares the atlas, so only the transform can keep two segments out of the same draw call
+b32 DrawSegmentsCanShareCall(DrawSegment *a, DrawSegment *b) {
+#ifdef BLOCKS_INSTANCED_BLOCKS
+    // A call draws all its instances before any of its vertices, so instances can't follow vertices in one
+    if (!IsInstancedEntryType(a->group->sortedEntries[a->endEntry - 1]->type) && IsInstancedEntryType(b->group->sortedEntries[b->firstEntry]->type)) {
+        return false;
+    }
+#endif
+    return a->group == b->group || memcmp(&a->group->transform, &b->group->transform, sizeof(mat4x4)) == 0;
+}
+
+inline
+void AddDrawSegment(DrawSegment *segments, u32 *segmentCount, u32 *drawCallCount, RenderGroup *group, RenderLayer layer, u32 firstEntry, u32 endEntry) {
+    DrawSegment *segment = &segments[*segmentCount];
+    segment->group = group;
+    segment->layer = layer;
+    segment->firstEntry = firstEntry;
+    segment->endEntry = endEntry;
+    segment->drawCallIndex = *drawCallCount;
+    if (*segmentCount && DrawSegmentsCanShareCall(segment - 1, segment)) {
+        segment->drawCallIndex = segment[-1].drawCallIndex;
+    }
+    else {
+        (*drawCallCount)++;
+    }
+    (*segmentCount)++;
+}
+
+#if defined(BLOCKS_INSTANCED_BLOCKS) && defined(BLOCKS_INDEXED_QUADS)
+// Instanced templates are drawn without indices, so this puts back the vertices PushVerts_() dropped
+u32 ExpandQuadVerts(BlocksVertex *out, BlocksVertex *quadVerts, u32 quadVertexCount) {
+    static const u32 QUAD_CORNERS[6] = {0, 1, 2, 1, 2, 3};
+    u32 count = 0;
+    for (u32 quad = 0; quad < quadVertexCount; quad += 4) {
+        for (u32 i = 0; i < 6; ++i) {
+            out[count++] = quadVerts[quad + QUAD_CORNERS[i]];
+        }
+    }
+    return count;
+}
+#endif
+
+inline
+void SetTemplateVertex(BlocksTemplateVertex *out, BlocksVertex *base, v2 stretch) {
+    out->offset = base->P;
+    out->stretch = stretch;
+#ifdef BLOCKS_COMPACT_VERTICES
+    out->uv[0] = base->uv[0];
+    out->uv[1] = base->uv[1];
+#else
+    out->uv = base->uv;
+#endif
+}
+
+// Works out each template from the block's vertex table: once at the origin, then with a unit of
+// horizontal and of vertical stretch to see which vertices move with each
+void BuildBlockTemplates(BlockTemplates *templates, Arena *arena) {
+    static const u32 MAX_TEMPLATE_VERTICES = 64;
+    BlocksVertex shapes[BLOCK_TEMPLATE_COUNT][3][MAX_TEMPLATE_VERTICES];
+    
+    templates->vertexStride = 0;
+    for (u32 type = 0; type < BLOCK_TEMPLATE_COUNT; ++type) {
+        for (u32 variant = 0; variant < 3; ++variant) {
+            RenderEntry entry = {};
+            entry.type = (RenderEntryType)type;
+            entry.scale = 1.0f;
+            entry.hStretch = (variant == 1) ? 1 : 0;
+            entry.vStretch = (variant == 2) ? 1 : 0;
+            
+            BlocksVertex pushed[MAX_TEMPLATE_VERTICES];
+            Arena shapeArena = {};
+            shapeArena.data = (u8 *)pushed;
+            shapeArena.size = sizeof(pushed);
+            PushBlockTableVerts(&shapeArena, &entry);
+            u32 pushedCount = (u32)(shapeArena.used / sizeof(BlocksVertex));
+            
+#if defined(BLOCKS_INSTANCED_BLOCKS) && defined(BLOCKS_INDEXED_QUADS)
+            u32 count = ExpandQuadVerts(shapes[type][variant], pushed, pushedCount);
+#else
+            u32 count = pushedCount;
+            memcpy(shapes[type][variant], pushed, count * sizeof(BlocksVertex));
+#endif
+            Assert(count <= MAX_TEMPLATE_VERTICES);
+            templates->vertexCounts[type] = count;
+        }
+        templates->vertexStride = Max(templates->vertexStride, templates->vertexCounts[type]);
+    }
+    
+#ifdef BLOCKS_INSTANCED_BLOCKS
+    // A glyph is PushChar()'s quad at a font scale of 1, with its corner at the glyph's offset from the pen.
+    // The instance's stretch is the glyph's scaled size, so each corner's stretch says which way it moves.
+    static const v2 GLYPH_CORNER_STRETCH[6] = {{0, 0}, {1, 0}, {0, 1}, {1, 0}, {0, 1}, {1, 1}};
+    BlocksVertex glyphs[GLYPH_TEMPLATE_COUNT][6];
+    for (u32 c = 0; c < GLYPH_TEMPLATE_COUNT; ++c) {
+        BlocksVertex pushed[6];
+        Arena glyphArena = {};
+        glyphArena.data = (u8 *)pushed;
+        glyphArena.size = sizeof(pushed);
+        PushChar(&glyphArena, FONT_DATA[c], 1.0f, v2{0, 0}, v4{}, v4{});
+#ifdef BLOCKS_INDEXED_QUADS
+        u32 count = ExpandQuadVerts(glyphs[c], pushed, (u32)(glyphArena.used / sizeof(BlocksVertex)));
+#else
+        u32 count = (u32)(glyphArena.used / sizeof(BlocksVertex));
+        memcpy(glyphs[c], pushed, count * sizeof(BlocksVertex));
+#endif
+        Assert(count == 6);
+        templates->vertexCounts[BLOCK_TEMPLATE_COUNT + c] = count;
+    }
+    templates->vertexStride = Max(templates->vertexStride, 6);
+#endif
+    
+    templates->vertices = PushArray(arena, BlocksTemplateVertex, TEMPLATE_COUNT * templates->vertexStride);
+    for (u32 index = 0; index < TEMPLATE_COUNT; ++index) {
+        BlocksTemplateVertex *out = templates->vertices + (index * templates->vertexStride);
+        u32 count = templates->vertexCounts[index];
+        for (u32 i = 0; i < count; ++i) {
+            if (index < BLOCK_TEMPLATE_COUNT) {
+                BlocksVertex *base = &shapes[index][0][i];
+                BlocksVertex *hStretched = &shapes[index][1][i];
+                BlocksVertex *vStretched = &shapes[index][2][i];
+                // Horizontal stretch only ever moves x, and vertical stretch only y
+                Assert(hStretched->P.y == base->P.y && vStretched->P.x == base->P.x);
+                SetTemplateVertex(&out[i], base, v2{hStretched->P.x - base->P.x, vStretched->P.y - base->P.y});
+            }
+#ifdef BLOCKS_INSTANCED_BLOCKS
+            else {
+                BlocksVertex *glyph = glyphs[index - BLOCK_TEMPLATE_COUNT];
+                SetTemplateVertex(&out[i], &glyph[i], GLYPH_CORNER_STRETCH[i]);
+                out[i].offset = glyph[0].P;
+            }
+#endif
+        }
+        // Pad with copies of the last vertex, which make degenerate triangles
+        for (u32 i = count; i < templates->vertexStride; ++i) {
+            out[i] = out[count - 1];
+        }
+    }
+}
+
+// CPU reference for the instanced vertex shader. Writes out the triangles for drawCall's instances,
+// leaving out template padding, and returns how many vertices that was.
+extern "C" u32 ExpandBlocksInstances(const BlocksRenderInfo *renderInfo, const BlocksDrawCall *drawCall, BlocksVertex *out) {
+    u32 vertexCount = 0;
+    for (umm instanceIdx = 0; instanceIdx < drawCall->instanceCount; ++instanceIdx) {
+        BlocksInstance *instance = &renderInfo->instanceData[drawCall->instanceOffset + instanceIdx];
+        Assert(instance->templateIndex < renderInfo->templateCount);
+        BlocksTemplateVertex *templateVerts = renderInfo->templateVertices + (instance->templateIndex * renderInfo->templateVertexStride);
+        u32 templateCount = renderInfo->templateVertexCounts[instance->templateIndex];
+        
+        BlocksVertex fill = {};
+        memcpy(&fill.color, &instance->color, sizeof(fill.color));
+        memcpy(&fill.outline, &instance->outline, sizeof(fill.outline));
+        InstantiateBlockTemplate(out + vertexCount, templateVerts, templateCount, instance->P, instance->stretch, instance->scale, fill);
+        vertexCount += templateCount;
+    }
+    return vertexCount;
+}
+
+#ifdef BLOCKS_INDEXED_QUADS
+// Every draw call is a run of quads, four vertices apiece, and its indices count from its own first
+// vertex. That makes them all the same sequence, so they share one run from the start of the buffer,
+// and the run stays in the workspace between frames so idle frames don't write it out again.
+void AssembleQuadIndexBuffer(BlocksRenderInfo *renderInfo) {
+    umm maxVertexCount = 0;
+    for (u32 i = 0; i < renderInfo->drawCallCount; ++i) {
+        BlocksDrawCall *drawCall = &renderInfo->drawCalls[i];
+        Assert(drawCall->vertexCount % 4 == 0);
+        drawCall->indexCount = (drawCall->vertexCount / 4) * 6;
+        drawCall->indexOffset = 0;
+        maxVertexCount = Max(maxVertexCount, drawCall->vertexCount);
+    }
+    
+    u32 quadCount = (u32)(maxVertexCount / 4);
+    u32 indexSize = (maxVertexCount <= 65536) ? sizeof(u16) : sizeof(u32);
+    QuadIndexBuffer *indices = &blocksCtx->quadIndices;
+    if (indices->indexSize != indexSize) {
+        indices->quadCount = 0;
+        indices->indexSize = indexSize;
+    }
+    if (quadCount > indices->quadCount) {
+        ReserveArray(&blocksCtx->workspace, u8, indices->data, indices->quadCount * 6 * indexSize, indices->capacity, quadCount * 6 * indexSize);
+        u16 *indices16 = (u16 *)indices->data;
+        u32 *indices32 = (u32 *)indices->data;
+        for (u32 quad = indices->quadCount; quad < quadCount; ++quad) {
+            u32 a = quad * 4;
+            u32 quadIndices[6] = {a, a + 1, a + 2, a + 1, a + 2, a + 3};
+            for (u32 i = 0; i < 6; ++i) {
+                if (indexSize == sizeof(u16)) {
+                    indices16[quad * 6 + i] = (u16)quadIndices[i];
+                }
+                else {
+                    indices32[quad * 6 + i] = quadIndices[i];
+                }
+            }
+        }
+        indices->quadCount = quadCount;
+    }
+    
+    renderInfo->indexSize = indexSize;
+    renderInfo->indexDataSize = quadCount * 6 * indexSize;
+    renderInfo->indexData = indices->data;
+}
+#endif
+
+inline
+void AddSnapCellEntry(SnapIndex *index, u32 candidate, s32 cellX, s32 cellY) {
+    u32 *bucket = &index->buckets[HashGridCell(cellX, cellY) & (index->bucketCount - 1)];
+    SnapCellEntry *entry = &index->entries[index->entryCount];
+    entry->candidate = candidate;
+    entry->cellX = cellX;
+    entry->cellY = cellY;
+    entry->nextInBucket = *bucket;
+    *bucket = index->entryCount++;
+}
+
+void AddSnapCandidate(InsertionType type, BlockHandle block, Script *script, Rectangle rect) {
+    SnapIndex *index = &blocksCtx->snapIndex;
+    Arena *workspace = &blocksCtx->workspace;
+    ReserveArray(workspace, SnapCandidate, index->candidates, index->candidateCount, index->candidateCapacity, index->candidateCount + 1);
+    u32 candidateIndex = index->candidateCount++;
+    SnapCandidate *candidate = &index->candidates[candidateIndex];
+    candidate->type = type;
+    candidate->block = block;
+    candidate->script = script->handle;
+    candidate->rect = rect;
+    
+    GridCellRange cells = GridCellsForRect(rect);
+    for (s32 cellY = cells.minY; cellY <= cells.maxY; ++cellY) {
+        for (s32 cellX = cells.minX; cellX <= cells.maxX; ++cellX) {
+            ReserveArray(workspace, SnapCellEntry, index->entries, index->entryCount, index->entryCapacity, index->entryCount + 1);
+            AddSnapCellEntry(index, candidateIndex, cellX, cellY);
+        }
+    }
+    
+    if (index->entryCount > index->bucketCount) {
+        // Double the buckets to keep chains short, and refile everything
+        index->bucketCount *= 2;
+        ReserveArray(workspace, u32, index->buckets, 0, index->bucketCapacity, index->bucketCount);
+        memset(index->buckets, 0, sizeof(u32) * index->bucketCount);
+        u32 entryCount = index->entryCount;
+        index->entryCount = 1;
+        for (u32 i = 1; i < entryCount; ++i) {
+            SnapCellEntry entry = index->entries[i];
+            AddSnapCellEntry(index, entry.candidate, entry.cellX, entry.cellY);
+        }
+    }
+}
+
+// Walks a stack the same way DrawSubScript() does (minus any ghost blocks), adding each connector
+// that fits the dragged blocks as it goes. Block sizes come from the layout cache.
+void CollectSnapCandidates(Script *script, BlockHandle block, Layout *layout) {
+    DragInfo *dragInfo = &blocksCtx->dragInfo;
+    BlockStore *store = &blocksCtx->blockStore;
+    while (block.index) {
+        u32 slot = GetBlockSlot(block);
+        BlockType type = (BlockType)store->types[slot];
+        BlockLinks *links = &store->links[slot];
+        BlockMetrics *metrics = &METRICS[type];
+        v2 P = layout->at;
+        
+        if (block == script->topBlock) {
+            if (HasInlet(type) && HasOutlet(dragInfo->lastBlockType)) {
+                AddSnapCandidate(InsertionType_Before, block, script, TranslateRectangle(metrics->inlet, P));
+            }
+            if (HasInlet(type) && HasInnerOutlet(dragInfo->firstBlockType) && !dragInfo->firstBlockHasInner) {
+                AddSnapCandidate(InsertionType_Around, block, script, Rectangle{P.x - 4, P.y, 8, 16});
+            }
+        }
+        
+        if (IsBranchBlockType(type)) {
+            if (HasInnerOutlet(type) && HasInlet(dragInfo->firstBlockType)) {
+                AddSnapCandidate(InsertionType_Inside, block, script, TranslateRectangle(metrics->innerOutlet, P));
+            }
+            
+            Layout innerLayout = CreateEmptyLayoutAt(P.x + metrics->innerOrigin.x, P.y + metrics->innerOrigin.y);
+            CollectSnapCandidates(script, links->inner, &innerLayout);
+        }
+        
+        BlockLayout *cached = &store->layouts[slot];
+        Assert(!cached->dirty);
+        layout->at.x += cached->size.w;
+        layout->bounds.w += cached->size.w;
+        layout->bounds.h = Max(layout->bounds.h, cached->size.h);
+        
+        if (HasOutlet(type) && HasInlet(dragInfo->firstBlockType)) {
+            AddSnapCandidate(InsertionType_After, block, script, TranslateRectangle(metrics->outlet, P));
+        }
+        
+        block = links->next;
+    }
 }
 
-inline
-RenderEntryType RenderEntryTypeForBlockInputType(BlockInputType type) {
-    switch (type) {
-        case BlockInputType_Number: return RenderEntryType_InputNumber;
-        case BlockInputType_Text:   return RenderEntryType_InputText;
-        default: break;
-    }
-    return RenderEntryType_Null;
+// Call once the dragged blocks are set in dragInfo
+void BeginSnapIndex() {
+    SnapIndex *index = &blocksCtx->snapIndex;
+    DragInfo *dragInfo = &blocksCtx->dragInfo;
+    
+    dragInfo->firstBlockType = GetBlockType(dragInfo->firstBlock);
+    dragInfo->lastBlockType = GetBlockType(dragInfo->lastBlock);
+    dragInfo->firstBlockHasInner = GetBlockLinks(dragInfo->firstBlock)->inner.index != 0;
+    dragInfo->readyToInsert = false; // Left over from the last drag otherwise
+    
+    index->candidateCount = 0;
+    index->entryCount = 1;
+    index->bucketCount = 64;
+    ReserveArray(&blocksCtx->workspace, SnapCellEntry, index->entries, 0, index->entryCapacity, 1);
+    ReserveArray(&blocksCtx->workspace, u32, index->buckets, 0, index->bucketCapacity, index->bucketCount);
+    memset(index->buckets, 0, sizeof(u32) * index->bucketCount);
+    index->dragIndex++;
 }
 
+void EndSnapIndex() {
+    SnapIndex *index = &blocksCtx->snapIndex;
+    index->candidateCount = 0;
+    index->entryCount = 0;
+    index->bucketCount = 0;
+}
 
 inline
-v4 ColorForBlockType(BlockType blockType) {
-    switch (blockType) {
-        case BlockType_Command: return SCRATCH_COLORS[SCRATCH_COLOR_MOTION_1];
-        case BlockType_Event:   return SCRATCH_COLORS[SCRATCH_COLOR_EVENTS_1];
-        case BlockType_EndCap:  return SCRATCH_COLORS[SCRATCH_COLOR_LOOKS_1];
-        case BlockType_Loop:    return SCRATCH_COLORS[SCRATCH_COLOR_CONTROL_1];
-        case BlockType_Forever: return SCRATCH_COLORS[SCRATCH_COLOR_SOUNDS_1];
-        default: {
-            Invalid;
-            break;
-        }
+void AddSnapCandidatesForScript(Script *script, Rectangle rect) {
+    SnapIndex *index = &blocksCtx->snapIndex;
+    if (script->snapDrag != index->dragIndex
+        && script->handle != blocksCtx->dragInfo.script
+        && RectsIntersect(script->bounds, rect)) {
+        script->snapDrag = index->dragIndex;
+        Layout layout = CreateEmptyLayoutAt(script->P);
+        CollectSnapCandidates(script, script->topBlock, &layout);
     }
-    return v4{1, 1, 1, 1};
 }
 
-inline
-v4 OutlineColorForBlockType(BlockType blockType) {
-    switch (blockType) {
-        case BlockType_Command: return SCRATCH_COLORS[SCRATCH_COLOR_MOTION_2];
-        case BlockType_Event:   return SCRATCH_COLORS[SCRATCH_COLOR_EVENTS_2];
-        case BlockType_EndCap:  return SCRATCH_COLORS[SCRATCH_COLOR_LOOKS_2];
-        case BlockType_Loop:    return SCRATCH_COLORS[SCRATCH_COLOR_CONTROL_2];
-        case BlockType_Forever: return SCRATCH_COLORS[SCRATCH_COLOR_SOUNDS_2];
-        default: {
-            Invalid;
-            break;
+// Gathers the connectors of any script near rect that hasn't been gathered yet this drag
+void AddSnapCandidatesNear(Rectangle rect) {
+    ScriptGrid *grid = &blocksCtx->scriptGrid;
+    GridCellRange cells = GridCellsForRect(rect);
+    u64 cellCount = (u64)(cells.maxX - cells.minX + 1) * (u64)(cells.maxY - cells.minY + 1);
+    if (cellCount > blocksCtx->scriptCount) {
+        // Dragging something huge, so just check every script like AddScriptsInRect() does
+        for (u32 i = 0; i < blocksCtx->scriptCount; ++i) {
+            Script *script = &blocksCtx->scripts[i];
+            if (script->inGrid) {
+                AddSnapCandidatesForScript(script, rect);
+            }
         }
+        return;
     }
-    return v4{1, 1, 1, 1};
-}
-
-v2 UnprojectMouse(v2 mouseP, RenderGroup *group) {
-    f32 projectedX = (((2.0 * mouseP.x) / blocksCtx->screenSize.w) - 1.0);
-    f32 projectedY = (((2.0 * mouseP.y) / blocksCtx->screenSize.h) - 1.0);
     
-    mat4x4 unprojection = group->invTransform;
-    v4 unprojectedP = unprojection * v4{projectedX, projectedY, 0, 1};
-    return unprojectedP.xy;
+    for (s32 cellY = cells.minY; cellY <= cells.maxY; ++cellY) {
+        for (s32 cellX = cells.minX; cellX <= cells.maxX; ++cellX) {
+            u32 nodeIndex = *GridBucketForCell(grid, cellX, cellY);
+            while (nodeIndex) {
+                ScriptGridNode *node = &grid->nodes[nodeIndex];
+                nodeIndex = node->nextInBucket;
+                if (node->cellX == cellX && node->cellY == cellY) {
+                    AddSnapCandidatesForScript(GetScript(node->script), rect);
+                }
+            }
+        }
+    }
 }
 
-void InitRenderGroup(RenderGroup *group, mat4x4 transform, mat4x4 invTransform) {
-    group->entryCount = 0;
-    group->transform = transform;
-    group->invTransform = invTransform;
-    group->mouseP = UnprojectMouse(blocksCtx->input.mouseP, group);
+inline
+v2 RectangleCenter(Rectangle rect) {
+    return v2{ rect.x + (rect.w / 2.0f), rect.y + (rect.h / 2.0f) };
 }
 
-void AssembleVertexBuferForRenderGroup(Arena *vertexArena, BlocksRenderInfo *renderInfo, RenderGroup* renderGroup) {
-    Assert(renderInfo->drawCallCount < ArrayCount(renderInfo->drawCalls));
-    
-    BlocksDrawCall *drawCall = &renderInfo->drawCalls[renderInfo->drawCallCount++];
-    drawCall->transform = renderGroup->transform;
-    
-    u8 *start = ArenaAt(vertexArena);
-    drawCall->vertexOffset = (u32)(start - renderInfo->vertexData) / VERTEX_SIZE;
-    
-    for (u32 entryIdx = 0; entryIdx < renderGroup->entryCount; ++entryIdx) {
-        RenderEntry *entry = &renderGroup->entries[entryIdx];
-        switch(entry->type) {
-            case RenderEntryType_Command: {
-                PushCommandBlockVerts(vertexArena, entry->P, entry->color, entry->outline, entry->scale);
-                break;
-            }
-            case RenderEntryType_Event: {
-                PushEventBlockVerts(vertexArena, entry->P, entry->color, entry->outline);
-                break;
-            }
-            case RenderEntryType_EndCap: {
-                PushEndCapBlockVerts(vertexArena, entry->P, entry->color, entry->outline);
-                break;
-            }
-            case RenderEntryType_Loop: {
-                PushLoopBlockVerts(vertexArena, entry->P, entry->color, entry->outline, entry->hStretch, entry->vStretch);
-                break;
-            }
-            case RenderEntryType_Forever: {
-                PushForeverBlockVerts(vertexArena, entry->P, entry->color, entry->outline, entry->hStretch, entry->vStretch);
-                break;
-            }
-            case RenderEntryType_InputNumber: {
-                PushNumberInputVerts(vertexArena, entry->P, entry->color, entry->outline);
-                break;
-            }
-            case RenderEntryType_InputText: {
-                PushTextInputVerts(vertexArena, entry->P, entry->color, entry->outline);
-                break;
-            }
-            case RenderEntryType_Rect: {
-                PushSolidRect(vertexArena, entry->rect, entry->color);
-                break;
-            }
-            case RenderEntryType_RectOutline: {
-                PushRectOutline(vertexArena, entry->rect, entry->color, entry->outline);
-                break;
-            }
-            case RenderEntryType_Text: {
-                PushFontString(vertexArena, entry->text, entry->P, entry->textHeight, entry->color, entry->outline);
-                break;
-            }
-            case RenderEntryType_Null: {
-                // No-op
-                // @TODO: Assert? Warning? Nothing?
-                break;
-            }
-        }
-        
-        #if 0
-        // Draw inlet, outlet, and innerOutlet hit-boxes
-        if (entry->block) {
-            BlockType type = entry->block->type;
-            BlockMetrics metrics = METRICS[type];
-            if (HasInlet(type)) {
-                Rectangle inletRect = {entry->P.x + metrics.inlet.origin.x, 
-                                       entry->P.y + metrics.inlet.origin.y,
-                                       metrics.inlet.size.w,
-                                       metrics.inlet.size.h};
-                DEBUGPushRectOutline(inletRect, v4{0, 1, 1, 1});
-            }
-            if (HasOutlet(type)) {
-                if (IsBranchBlockType(type)) {
-                    Rectangle outletRect = {entry->P.x + metrics.outlet.origin.x + entry->hStretch, 
-                                            entry->P.y + metrics.outlet.origin.y,
-                                            metrics.outlet.size.w,
-                                            metrics.outlet.size.h};
-                    DEBUGPushRectOutline(outletRect, v4{1, 0, 1, 1});
+// Checks the candidates of the given types that connector overlaps, keeping whichever is closest
+void QuerySnapIndex(Rectangle connector, u32 typeMask, u32 *bestIndex, f32 *bestDistSq) {
+    SnapIndex *index = &blocksCtx->snapIndex;
+    v2 center = RectangleCenter(connector);
+    u32 bucketMask = index->bucketCount - 1;
+    GridCellRange cells = GridCellsForRect(connector);
+    for (s32 cellY = cells.minY; cellY <= cells.maxY; ++cellY) {
+        for (s32 cellX = cells.minX; cellX <= cells.maxX; ++cellX) {
+            u32 entryIndex = index->buckets[HashGridCell(cellX, cellY) & bucketMask];
+            while (entryIndex) {
+                SnapCellEntry *entry = &index->entries[entryIndex];
+                entryIndex = entry->nextInBucket;
+                if (entry->cellX != cellX || entry->cellY != cellY) {
+                    continue;
                 }
-                else {
-                    Rectangle outletRect = {entry->P.x + metrics.outlet.origin.x, 
-                                            entry->P.y + metrics.outlet.origin.y,
-                                            metrics.outlet.size.w,
-                                            metrics.outlet.size.h};
-                    DEBUGPushRectOutline(outletRect, v4{1, 0, 1, 1});
+                
+                u32 candidateIndex = entry->candidate;
+                SnapCandidate *candidate = &index->candidates[candidateIndex];
+                if (!(typeMask & (1 << candidate->type)) || !RectsIntersect(candidate->rect, connector)) {
+                    continue;
+                }
+                
+                // Ties go to whichever was collected first, which matches the order drawing used to check them in
+                f32 distSq = DistSq(center, RectangleCenter(candidate->rect));
+                if (*bestIndex == index->candidateCount
+                    || distSq < *bestDistSq
+                    || (distSq == *bestDistSq && candidateIndex < *bestIndex)) {
+                    *bestIndex = candidateIndex;
+                    *bestDistSq = distSq;
                 }
-            }
-            if (HasInnerOutlet(type)) {
-                Rectangle innerOutletRect = {entry->P.x + metrics.innerOutlet.origin.x, 
-                                             entry->P.y + metrics.innerOutlet.origin.y,
-                                             metrics.innerOutlet.size.w,
-                                             metrics.innerOutlet.size.h};
-                DEBUGPushRectOutline(innerOutletRect, v4{1, 1, 0, 1});
             }
         }
-        #endif
-        
     }
-    drawCall->vertexCount = (u32)(ArenaAt(vertexArena) - start) / VERTEX_SIZE;
+}
+
+// Picks where the dragged blocks would go if they were dropped right now. Call once the dragged
+// connectors are up to date for the frame. Drawing then just puts the ghost block wherever this says.
+void FindSnapTarget() {
+    DragInfo *dragInfo = &blocksCtx->dragInfo;
+    SnapIndex *index = &blocksCtx->snapIndex;
+    dragInfo->readyToInsert = false;
+    if (!index->bucketCount) {
+        return;
+    }
+    
+    AddSnapCandidatesNear(InflateRectangle(dragInfo->scriptLayout.bounds, SNAP_MARGIN));
+    
+    u32 bestIndex = index->candidateCount; // None yet
+    f32 bestDistSq = 0;
+    if (HasOutlet(dragInfo->lastBlockType)) {
+        QuerySnapIndex(dragInfo->outlet, 1 << InsertionType_Before, &bestIndex, &bestDistSq);
+    }
+    if (HasInlet(dragInfo->firstBlockType)) {
+        QuerySnapIndex(dragInfo->inlet, (1 << InsertionType_Inside) | (1 << InsertionType_After), &bestIndex, &bestDistSq);
+    }
+    if (HasInnerOutlet(dragInfo->firstBlockType)) {
+        QuerySnapIndex(dragInfo->innerOutlet, 1 << InsertionType_Around, &bestIndex, &bestDistSq);
+    }
+    
+    if (bestIndex < index->candidateCount) {
+        SnapCandidate *best = &index->candidates[bestIndex];
+        dragInfo->readyToInsert = true;
+        dragInfo->insertionType = best->type;
+        dragInfo->insertionBaseBlock = best->block;
+        dragInfo->insertionBaseScript = best->script;
+    }
+}
+
+// True if the ghost block for the current drag goes somewhere in script, which changes how it's laid out
+inline
+b32 IsInsertionScript(Script *script) {
+    DragInfo *dragInfo = &blocksCtx->dragInfo;
+    return Dragging() && dragInfo->readyToInsert && dragInfo->insertionBaseScript == script->handle;
+}
+
+// True if the ghost block for the current drag should be drawn at block
+inline
+b32 IsInsertionPoint(BlockHandle block, InsertionType type) {
+    DragInfo *dragInfo = &blocksCtx->dragInfo;
+    return Dragging() && dragInfo->readyToInsert && dragInfo->insertionType == type && dragInfo->insertionBaseBlock == block;
 }
 
 void BeginBlocks(BlocksInput input) {
     blocksCtx->input = input;
+    blocksCtx->frameIndex++;
     
     // Clear per-frame memory
-    blocksCtx->frame.used = 0;
+    ClearArena(&blocksCtx->frame);
+    ClearArena(&blocksCtx->scratch);
     
     blocksCtx->hot.type = InteractionType_None;
     blocksCtx->nextHot.type = InteractionType_None;
@@ -408,52 +1937,60 @@ BlocksRenderInfo EndBlocks() {
                     DragInfo dragInfo = blocksCtx->dragInfo;
                     // Drop and combine stacks as necessary
                     if (dragInfo.readyToInsert) {
+                        BlockType firstBlockType = GetBlockType(dragInfo.firstBlock);
+                        BlockType lastBlockType = GetBlockType(dragInfo.lastBlock);
+                        Script *insertionBaseScript = GetScript(dragInfo.insertionBaseScript);
+                        
                         // @NOTE: We *always* keep the script we're adding the dragging blocks to and throw out the dragging script
                         switch(dragInfo.insertionType) {
                             case InsertionType_Before: {
-                                Assert(HasOutlet(dragInfo.lastBlock->type));
+                                Assert(HasOutlet(lastBlockType));
                                 Connect(dragInfo.lastBlock, dragInfo.insertionBaseBlock);
-                                dragInfo.insertionBaseScript->topBlock = dragInfo.firstBlock;
-                                dragInfo.insertionBaseScript->P.x -= dragInfo.scriptLayout.bounds.w;
+                                SetScriptTopBlock(dragInfo.insertionBaseScript, dragInfo.firstBlock);
+                                insertionBaseScript->P.x -= dragInfo.scriptLayout.bounds.w;
                                 DeleteScript(dragInfo.script);
                                 break;
                             }
                             case InsertionType_After: {
-                                Block *next = dragInfo.insertionBaseBlock->next;
-                                if (next) {
-                                    Disconnect(next);
+                                BlockHandle next = GetBlockLinks(dragInfo.insertionBaseBlock)->next;
+                                b32 nextGoesInside = next.index && IsBranchBlockType(firstBlockType) && !GetBlockLinks(dragInfo.firstBlock)->inner.index;
+                                if (next.index && !nextGoesInside && HasOutlet(lastBlockType)) {
+                                    // Splicing the blocks in between leaves the end of the stack where it was
+                                    Connect(dragInfo.insertionBaseBlock, dragInfo.firstBlock);
+                                    Connect(dragInfo.lastBlock, next);
                                 }
-                                Connect(dragInfo.insertionBaseBlock, dragInfo.firstBlock);
-                                if (next) {
-                                    if (IsBranchBlockType(dragInfo.firstBlock->type) && !dragInfo.firstBlock->inner) {
-                                        ConnectInner(dragInfo.firstBlock, next);
-                                    }
-                                    else if (HasOutlet(dragInfo.lastBlock->type)) {
-                                        Connect(dragInfo.lastBlock, next);
-                                    }
-                                    else {
-                                        // The last block we're inserting doesn't have an outlet (e.g., forever or stop)
-                                        // So we take the rest of the existing stack and turn it into a new script
-                                        // 
-                                        // @TODO: Better method for placing the new stack
-                                        Script *restOfStack = CreateScript(dragInfo.scriptLayout.at);
-                                        restOfStack->topBlock = next;
+                                else {
+                                    if (next.index) {
+                                        // The rest of the stack gets moved before it's cut off, since moving it finds the end of it
+                                        BlockHandle nextLast;
+                                        if (nextGoesInside) {
+                                            nextLast = ConnectInner(dragInfo.firstBlock, next);
+                                        }
+                                        else {
+                                            // The last block we're inserting doesn't have an outlet (e.g., forever or stop)
+                                            // So we take the rest of the existing stack and turn it into a new script
+                                            // 
+                                            // @TODO: Better method for placing the new stack
+                                            nextLast = GetScript(CreateScript(dragInfo.scriptLayout.at, next))->lastBlock;
+                                        }
+                                        Disconnect(next, nextLast);
                                     }
+                                    Connect(dragInfo.insertionBaseBlock, dragInfo.firstBlock);
                                 }
                                 DeleteScript(dragInfo.script);
                                 break;
                             }
                             case InsertionType_Inside: {
-                                Block *inner = dragInfo.insertionBaseBlock->inner;
-                                if (inner) {
+                                BlockHandle inner = GetBlockLinks(dragInfo.insertionBaseBlock)->inner;
+                                if (inner.index) {
                                     DisconnectInner(inner);
                                 }
                                 ConnectInner(dragInfo.insertionBaseBlock, dragInfo.firstBlock);
-                                if (inner) {
-                                    if (IsBranchBlockType(dragInfo.firstBlock->type) && !dragInfo.firstBlock->inner) {
+                                if (inner.index) {
+                                    if (IsBranchBlockType(firstBlockType) && !GetBlockLinks(dragInfo.firstBlock)->inner.index) {
                                         ConnectInner(dragInfo.firstBlock, inner);
                                     }
-                                    else if (HasOutlet(dragInfo.lastBlock->type)) {
+                                    else if (HasOutlet(lastBlockType)) {
                                         Connect(dragInfo.lastBlock, inner);
                                     }
                                     else {
@@ -461,18 +1998,17 @@ BlocksRenderInfo EndBlocks() {
                                         // So we take the rest of the existing stack and turn it into a new script
                                         // 
                                         // @TODO: Better method for placing the new stack
-                                        Script *restOfStack = CreateScript(dragInfo.scriptLayout.at);
-                                        restOfStack->topBlock = inner;
+                                        CreateScript(dragInfo.scriptLayout.at, inner);
                                     }
                                 }
                                 DeleteScript(dragInfo.script);
                                 break;
                             }
                             case InsertionType_Around: {
-                                Assert(HasInnerOutlet(dragInfo.firstBlock->type) && !dragInfo.firstBlock->inner);
+                                Assert(HasInnerOutlet(firstBlockType) && !GetBlockLinks(dragInfo.firstBlock)->inner.index);
                                 ConnectInner(dragInfo.firstBlock, dragInfo.insertionBaseBlock);
-                                dragInfo.insertionBaseScript->topBlock = dragInfo.firstBlock;
-                                dragInfo.insertionBaseScript->P.x -= 6;
+                                SetScriptTopBlock(dragInfo.insertionBaseScript, dragInfo.firstBlock);
+                                insertionBaseScript->P.x -= 6;
                                 DeleteScript(dragInfo.script);
                                 break;
                             }
@@ -485,6 +2021,7 @@ BlocksRenderInfo EndBlocks() {
             }
             
             blocksCtx->interacting = {};
+            EndSnapIndex();
         }
         else {
             // Update interaction
@@ -495,29 +2032,26 @@ BlocksRenderInfo EndBlocks() {
                         interact->type = InteractionType_BlockDrag;
                         
                         // If we're in the middle of a stack, tear off into a new stack
-                        Block *hotBlock = interact->block;
+                        BlockHandle hotBlock = interact->block;
                         if (!IsTopBlock(hotBlock)) {
-                            Script *newScript = TearOff(hotBlock, interact->blockP);
-                            interact->script = newScript;
+                            interact->script = TearOff(hotBlock, interact->blockP);
                             interact->mouseOffset = { interact->mouseStartP.x - interact->blockP.x, interact->mouseStartP.y - interact->blockP.y };
                         }
                         
                         // Set constant dragInfo
-                        Script *script = blocksCtx->interacting.script;
-                        blocksCtx->dragInfo.script = script;
+                        Script *script = GetScript(blocksCtx->interacting.script);
+                        blocksCtx->dragInfo.script = script->handle;
                         blocksCtx->dragInfo.firstBlock = script->topBlock;
-                        Block *lastBlock = script->topBlock;
-                        while (lastBlock->next) {
-                            lastBlock = lastBlock->next;
-                        }
-                        blocksCtx->dragInfo.lastBlock = lastBlock;
+                        blocksCtx->dragInfo.lastBlock = script->lastBlock;
+                        BeginSnapIndex();
                     }
                     break;
                 }
                 case InteractionType_BlockDrag: {
-                    Script *script = interact->script;
+                    Script *script = GetScript(interact->script);
                     script->P.x = blocksCtx->blocksRenderGroup.mouseP.x - interact->mouseOffset.x;
                     script->P.y = blocksCtx->blocksRenderGroup.mouseP.y - interact->mouseOffset.y;
+                    MarkScriptDirty(interact->script);
                     
                     break;
                 }
@@ -534,11 +2068,13 @@ BlocksRenderInfo EndBlocks() {
             if (blocksCtx->hot.type == InteractionType_NewBlockSelect) {
                 // Start a dragging interaction with a new block, instead of passing along the existing interaction
                 v2 P = blocksCtx->blocksRenderGroup.mouseP;
-                Script *script = CreateScript(P);
-                Block *block = CreateBlock(BlockType_Command);
-                script->topBlock = block;
+                BlockHandle block = CreateBlock(BlockType_Command);
+                ScriptHandle script = CreateScript(P, block);
                 
-                RenderEntry *entry = PushRenderEntry(&blocksCtx->blocksRenderGroup);
+                RenderGroup *blocksRenderGroup = &blocksCtx->blocksRenderGroup;
+                blocksRenderGroup->layer = RenderLayer_Drag;
+                RenderEntry *entry = PushRenderEntry(blocksRenderGroup);
+                blocksRenderGroup->layer = RenderLayer_Blocks;
                 entry->type = RenderEntryTypeForBlockType(BlockType_Command);
                 entry->block = block;
                 entry->P = P;
@@ -559,6 +2095,7 @@ BlocksRenderInfo EndBlocks() {
                 blocksCtx->dragInfo.script = script;
                 blocksCtx->dragInfo.firstBlock = block;
                 blocksCtx->dragInfo.lastBlock = block;
+                BeginSnapIndex();
                 
                 blocksCtx->interacting = interaction;
             }
@@ -576,26 +2113,104 @@ BlocksRenderInfo EndBlocks() {
     
     // Assmble vertex buffer
     BlocksRenderInfo Result = {};
-    Result.vertexData = ArenaAt(&blocksCtx->frame);
+    RenderGroup *groups[] = {
+        &blocksCtx->blocksRenderGroup,
+        &blocksCtx->uiRenderGroup,
+    };
+    for (u32 i = 0; i < ArrayCount(groups); ++i) {
+        SortRenderGroup(groups[i], &blocksCtx->scratch);
+    }
+    
+    // Layer by layer, skipping groups with nothing in a layer. Consecutive segments only need
+    // separate draw calls when they can't share one.
+    u32 maxSegmentCount = ArrayCount(groups) * RenderLayerCount;
+#ifdef BLOCKS_INSTANCED_BLOCKS
+    for (u32 i = 0; i < ArrayCount(groups); ++i) {
+        maxSegmentCount += groups[i]->entryCount;
+    }
+#endif
+    AlignArena(&blocksCtx->scratch, 16);
+    DrawSegment *segments = PushArray(&blocksCtx->scratch, DrawSegment, maxSegmentCount);
+    u32 segmentCount = 0;
+    for (u32 layer = 0; layer < RenderLayerCount; ++layer) {
+        for (u32 i = 0; i < ArrayCount(groups); ++i) {
+            RenderGroup *group = groups[i];
+            u32 firstEntry = group->layerStarts[layer];
+            u32 endEntry = group->layerStarts[layer + 1];
+            if (firstEntry == endEntry) {
+                continue;
+            }
+            
+#ifdef BLOCKS_INSTANCED_BLOCKS
+            // Every run of instances that comes after vertices starts a segment, so it can go in a call of its own
+            // instead of under them (e.g., a block under the text of the one before it when their scripts overlap)
+            for (u32 entryIndex = firstEntry + 1; entryIndex < endEntry; ++entryIndex) {
+                if (IsInstancedEntryType(group->sortedEntries[entryIndex]->type) && !IsInstancedEntryType(group->sortedEntries[entryIndex - 1]->type)) {
+                    AddDrawSegment(segments, &segmentCount, &Result.drawCallCount, group, (RenderLayer)layer, firstEntry, entryIndex);
+                    firstEntry = entryIndex;
+                }
+            }
+#endif
+            AddDrawSegment(segments, &segmentCount, &Result.drawCallCount, group, (RenderLayer)layer, firstEntry, endEntry);
+        }
+    }
     
-    AssembleVertexBuferForRenderGroup(&blocksCtx->frame, &Result, &blocksCtx->blocksRenderGroup);
-    AssembleVertexBuferForRenderGroup(&blocksCtx->frame, &Result, &blocksCtx->uiRenderGroup);
-    AssembleVertexBuferForRenderGroup(&blocksCtx->frame, &Result, &blocksCtx->dragRenderGroup);
-    AssembleVertexBuferForRenderGroup(&blocksCtx->frame, &Result, &blocksCtx->debugRenderGroup);
-    AssembleVertexBuferForRenderGroup(&blocksCtx->frame, &Result, &blocksCtx->fontRenderGroup);
+    AlignArena(&blocksCtx->frame, 16);
+    Result.drawCalls = PushArray(&blocksCtx->frame, BlocksDrawCall, Result.drawCallCount);
+    
+    BeginContiguousRegion(&blocksCtx->frame);
+    for (u32 i = 0; i < segmentCount; ++i) {
+        DrawSegment *segment = &segments[i];
+        BlocksDrawCall *drawCall = &Result.drawCalls[segment->drawCallIndex];
+        if (!i || segment[-1].drawCallIndex != segment->drawCallIndex) {
+            *drawCall = {};
+            drawCall->transform = segment->group->transform;
+            // Offsets are relative to the start of the contiguous vertex region, which may move if the arena grows
+            drawCall->vertexOffset = ContiguousRegionSize(&blocksCtx->frame) / VERTEX_SIZE;
+        }
+        
+        AssembleVertexBuferForRenderGroup(&blocksCtx->frame, segment);
+        drawCall->vertexCount = (ContiguousRegionSize(&blocksCtx->frame) / VERTEX_SIZE) - drawCall->vertexOffset;
+    }
     
-    Result.vertexDataSize = (u32)(ArenaAt(&blocksCtx->frame) - Result.vertexData);
+    Result.vertexDataSize = ContiguousRegionSize(&blocksCtx->frame);
+    Result.vertexData = EndContiguousRegion(&blocksCtx->frame);
+#ifdef BLOCKS_INDEXED_QUADS
+    AssembleQuadIndexBuffer(&Result);
+#endif
+#ifdef BLOCKS_INSTANCED_BLOCKS
+    AlignArena(&blocksCtx->frame, 16);
+    BeginContiguousRegion(&blocksCtx->frame);
+    for (u32 i = 0; i < segmentCount; ++i) {
+        DrawSegment *segment = &segments[i];
+        BlocksDrawCall *drawCall = &Result.drawCalls[segment->drawCallIndex];
+        if (!i || segment[-1].drawCallIndex != segment->drawCallIndex) {
+            drawCall->instanceOffset = ContiguousRegionSize(&blocksCtx->frame) / sizeof(BlocksInstance);
+        }
+        
+        AssembleInstanceBufferForRenderGroup(&blocksCtx->frame, segment);
+        drawCall->instanceCount = (ContiguousRegionSize(&blocksCtx->frame) / sizeof(BlocksInstance)) - drawCall->instanceOffset;
+    }
+    Result.instanceDataSize = ContiguousRegionSize(&blocksCtx->frame);
+    Result.instanceData = (BlocksInstance *)EndContiguousRegion(&blocksCtx->frame);
+    
+    BlockTemplates *templates = &blocksCtx->blockTemplates;
+    Result.templateVertices = templates->vertices;
+    Result.templateVertexCounts = templates->vertexCounts;
+    Result.templateVertexStride = templates->vertexStride;
+    Result.templateCount = TEMPLATE_COUNT;
+#endif
     return Result;
 }
 
 void RenderNewBlockButton(RenderGroup *renderGroup) {
-    BlockMetrics metrics = METRICS[BlockType_Command];
+    BlockMetrics *metrics = &METRICS[BlockType_Command];
     v2 screenSize = blocksCtx->screenSize;
     f32 scale = 4.0f;
     f32 edgePadding = 20.0f;
-    v2 P = {screenSize.w - edgePadding - (scale * metrics.size.w),
-            screenSize.h - edgePadding - (scale * metrics.size.h)};
-    Rectangle hitBox = {P.x, P.y, scale * metrics.size.w, scale * metrics.size.h};
+    v2 P = {screenSize.w - edgePadding - (scale * metrics->size.w),
+            screenSize.h - edgePadding - (scale * metrics->size.h)};
+    Rectangle hitBox = {P.x, P.y, scale * metrics->size.w, scale * metrics->size.h};
     
     RenderEntry *entry = PushRenderEntry(renderGroup);
     entry->type = RenderEntryType_Command;
@@ -655,9 +2270,11 @@ char *PushFormattedText(Arena *arena, const char *formatStr, ...) {
     return textBuf;
 }
 
-// @TODO: This is overkill, just copy the bytes
 char *PushText(Arena *arena, const char *text) {
-    return PushFormattedText(arena, "%s", text);
+    umm size = strlen(text) + 1;
+    char *textBuf = (char *)PushSize(arena, size);
+    memcpy(textBuf, text, size);
+    return textBuf;
 }
 
 void RenderInput(RenderGroup *renderGroup, BlockInputType type, v2 position, v4 color, v4 outline) {
@@ -669,203 +2286,205 @@ void RenderInput(RenderGroup *renderGroup, BlockInputType type, v2 position, v4
 }
 
 Layout RenderScript(RenderGroup *renderGroup, Script *script) {
-    Assert(script->topBlock);
+    Assert(script->topBlock.index);
+    UpdateStackLayout(script->topBlock);
     
     Layout layout = CreateEmptyLayoutAt(script->P);
     DrawSubScript(renderGroup, script->topBlock, script, &layout);
     return layout;
 }
 
-void DrawSubScript(RenderGroup *renderGroup, Block *block, Script *script, Layout *layout) {
-    Assert(block);
+inline
+void PushCachedVerts(RenderGroup *renderGroup, Script *script) {
+    RenderEntry *entry = PushRenderEntry(renderGroup);
+    entry->type = RenderEntryType_CachedVerts;
+    entry->span = script->cachedVerts;
+}
+
+inline
+void AddVertexCapture(RenderGroup *renderGroup, Script *script, u32 firstEntry) {
+    if (renderGroup->captureCount == renderGroup->captureCapacity) {
+        AlignArena(&blocksCtx->scratch, 16); // Text gets pushed to scratch too, so it could be anywhere
+    }
+    ReserveArray(&blocksCtx->scratch, VertexCapture, renderGroup->captures, renderGroup->captureCount, renderGroup->captureCapacity, renderGroup->captureCount + 1);
+    VertexCapture *capture = &renderGroup->captures[renderGroup->captureCount++];
+    capture->script = script->handle;
+    capture->firstKey = RenderSortKey(renderGroup, firstEntry);
+    capture->endKey = RenderSortKey(renderGroup, renderGroup->entryCount);
+}
+
+// Draws a script into the workspace render groups, reusing the vertices from the last time it was drawn if nothing
+// could have changed them. That means it's all on screen (so none of it was culled), it's not under the mouse
+// (so nothing needs hit testing or highlighting), and it isn't getting a ghost block.
+void DrawScript(Script *script) {
+    RenderGroup *blocksRenderGroup = &blocksCtx->blocksRenderGroup;
+    b32 cacheable = !script->boundsDirty
+        && script->pickFrame != blocksCtx->frameIndex
+        && !IsInsertionScript(script)
+        && RectContainsRect(blocksRenderGroup->cullBounds, script->bounds);
+#ifdef BLOCKS_INSTANCED_BLOCKS
+    // Blocks go out as instances, which a capture of the group's vertices would leave behind
+    cacheable = false;
+#endif
+    
+    if (cacheable && script->cachedVerts.valid) {
+        PushCachedVerts(blocksRenderGroup, script);
+        return;
+    }
+    
+    u32 firstEntry = blocksRenderGroup->entryCount;
+    Layout layout = RenderScript(blocksRenderGroup, script);
+    if (cacheable) {
+        AddVertexCapture(blocksRenderGroup, script, firstEntry);
+    }
+    UpdateScriptBounds(script, layout.bounds);
+}
+
+void DrawSubScript(RenderGroup *renderGroup, BlockHandle block, Script *script, Layout *layout) {
+    Assert(block.index);
+    
+    if (!IsInsertionScript(script)) {
+        // Nothing in here is changing shape, so the cache already knows how much room the stack takes.
+        // Only the part of it that's on screen needs to be walked.
+        Assert(layout->bounds.w == 0);
+        BlockLayout *cached = GetBlockLayout(block);
+        Assert(!cached->dirty);
+        Rectangle stackBounds = {layout->at.x, layout->at.y, cached->stackSize.w, cached->stackSize.h};
+        if (RectsIntersect(stackBounds, renderGroup->cullBounds)) {
+            // Blocks only ever run left to right, so everything past the right edge of the screen is off it too
+            f32 cullRight = renderGroup->cullBounds.x + renderGroup->cullBounds.w;
+            BlockHandle nextBlock = block;
+            while (nextBlock.index && layout->at.x <= cullRight) {
+                DrawBlock(renderGroup, nextBlock, script, layout);
+                nextBlock = GetBlockLinks(nextBlock)->next;
+            }
+        }
+        layout->at.x = stackBounds.x + stackBounds.w;
+        layout->bounds = stackBounds;
+        return;
+    }
+    
     // Draw a single linear group of blocks, only recursing on branching blocks
-    Rectangle inletBounds = {layout->at.x - 4, layout->at.y, 8, 16};
-    Block *nextBlock = block;
-    while (nextBlock) {
+    BlockHandle nextBlock = block;
+    while (nextBlock.index) {
         if(DrawBlock(renderGroup, nextBlock, script, layout)) {
-            nextBlock = nextBlock->next;
+            nextBlock = GetBlockLinks(nextBlock)->next;
         }
         else {
-            nextBlock = 0;
-        }
-    }
-    
-    // If we're dragging a branch block, check to see if we should place it around another stack
-    if (Dragging() && !blocksCtx->dragInfo.readyToInsert) {
-        DragInfo dragInfo = blocksCtx->dragInfo;
-        if (dragInfo.script != script 
-            && !dragInfo.script->topBlock->inner
-            && HasInnerOutlet(dragInfo.firstBlock->type)
-            && HasInlet(block->type)) {
-            if (RectsIntersect(inletBounds, dragInfo.innerOutlet)) {
-                Layout loopLayout = CreateEmptyLayoutAt(layout->bounds.origin.x - 6, layout->bounds.origin.y);
-                DrawGhostBlock(renderGroup, dragInfo.firstBlock->type, &loopLayout, layout);
-                blocksCtx->dragInfo.readyToInsert = true;
-                blocksCtx->dragInfo.insertionType = InsertionType_Around;
-                blocksCtx->dragInfo.insertionBaseBlock = block;
-                blocksCtx->dragInfo.insertionBaseScript = script;
-                // DEBUGPushRectOutline(loopLayout.bounds, {0, 1, 0, 1});
-            }
+            nextBlock = {};
         }
     }
     
+    // If we're dragging a branch block around this stack, draw its ghost around everything we just drew
+    if (IsInsertionPoint(block, InsertionType_Around)) {
+        Layout loopLayout = CreateEmptyLayoutAt(layout->bounds.origin.x - 6, layout->bounds.origin.y);
+        DrawGhostBlock(renderGroup, blocksCtx->dragInfo.firstBlockType, &loopLayout, layout);
+        // DEBUGPushRectOutline(loopLayout.bounds, {0, 1, 0, 1});
+    }
+    
     #if 0
     // Draw layout bounds
     DEBUGPushRectOutline(layout->bounds, {0, 1, 0, 1});
     #endif
 }
 
-b32 DrawBlock(RenderGroup *renderGroup, Block *block, Script *script, Layout *layout) {
-    DragInfo dragInfo = blocksCtx->dragInfo;
+b32 DrawBlock(RenderGroup *renderGroup, BlockHandle block, Script *script, Layout *layout) {
+    // Where the ghost block goes was already decided by FindSnapTarget(), so all we do here is make room for it
+    DragInfo *dragInfo = &blocksCtx->dragInfo;
+    
+    // Look the block up once. Nothing moves while we're drawing, so these stay good through the recursion.
+    u32 slot = GetBlockSlot(block);
+    BlockType type = (BlockType)blocksCtx->blockStore.types[slot];
+    BlockLinks *links = &blocksCtx->blockStore.links[slot];
     
     // Draw ghost block before this block, if necessary
-    if (Dragging()
-        && dragInfo.script != script
-        && IsTopBlockOfScript(block, script)
-        && !blocksCtx->dragInfo.readyToInsert 
-        && HasInlet(block->type)
-        && HasOutlet(dragInfo.lastBlock->type))
-    {
-        BlockMetrics blockMetrics = METRICS[block->type];
-        BlockMetrics dragBlockMetrics = METRICS[dragInfo.lastBlock->type];
-        Rectangle inletBounds = TranslateRectangle(blockMetrics.inlet, script->P);
-        // DEBUGPushRectOutline(inletBounds, COLOR_RED);
-        if (RectsIntersect(inletBounds, dragInfo.outlet)) {
-            layout->at.x -= dragBlockMetrics.size.w;
-            layout->bounds.x -= dragBlockMetrics.size.w;
-            DrawGhostBlock(renderGroup, dragInfo.lastBlock->type, layout);
-            
-            blocksCtx->dragInfo.readyToInsert = true;
-            blocksCtx->dragInfo.insertionType = InsertionType_Before;
-            blocksCtx->dragInfo.insertionBaseBlock = block;
-            blocksCtx->dragInfo.insertionBaseScript = script;
-        }
+    if (IsInsertionPoint(block, InsertionType_Before)) {
+        BlockMetrics *dragBlockMetrics = &METRICS[dragInfo->lastBlockType];
+        layout->at.x -= dragBlockMetrics->size.w;
+        layout->bounds.x -= dragBlockMetrics->size.w;
+        DrawGhostBlock(renderGroup, dragInfo->lastBlockType, layout);
     }
     
     // Draw the block
-    if (IsSimpleBlockType(block->type)) {
-        DrawSimpleBlock(renderGroup, block->type, block, script, layout);
+    if (IsSimpleBlockType(type)) {
+        DrawSimpleBlock(renderGroup, type, block, script, layout);
     }
-    else if (IsBranchBlockType(block->type)) {
-        BlockMetrics blockMetrics = METRICS[block->type];
-        Layout innerLayout = CreateEmptyLayoutAt(layout->at.x + blockMetrics.innerOrigin.x, layout->at.y + blockMetrics.innerOrigin.y);
+    else if (IsBranchBlockType(type)) {
+        BlockMetrics *blockMetrics = &METRICS[type];
+        Layout innerLayout = CreateEmptyLayoutAt(layout->at.x + blockMetrics->innerOrigin.x, layout->at.y + blockMetrics->innerOrigin.y);
         b32 renderedInner = false;
         
         // Draw ghost block inside the branch, if necessary
-        if (Dragging() 
-            && dragInfo.script != script 
-            && !blocksCtx->dragInfo.readyToInsert
-            && HasInnerOutlet(block->type)
-            && HasInlet(dragInfo.firstBlock->type)) 
-        {
-            Rectangle innerOutletBounds = TranslateRectangle(blockMetrics.innerOutlet, layout->at);
-            // DEBUGPushRectOutline(innerOutletBounds, COLOR_GREEN);
-            if (RectsIntersect(innerOutletBounds, dragInfo.inlet)) {
-                if (IsSimpleBlockType(dragInfo.firstBlock->type)) {
-                    DrawGhostBlock(renderGroup, dragInfo.firstBlock->type, &innerLayout);
-                }
-                else if (IsBranchBlockType(block->type)) {
-                    // Override block drawing so that branch contains the rest of the substack
-                    BlockMetrics dragMetrics = METRICS[dragInfo.firstBlock->type]; // @TODO: Double-check this. Is this the right metrics to be grabbing here?
-                    Layout innerInnerLayout = CreateEmptyLayoutAt(innerLayout.at.x + dragMetrics.innerOrigin.x, innerLayout.at.y);
-                    if (block->inner && !dragInfo.firstBlock->inner) {
-                        blocksCtx->dragInfo.readyToInsert = true; // Set this here so that the inner substack doesn't also try to draw a ghost block
-                        DrawSubScript(renderGroup, block->inner, script, &innerInnerLayout);
-                        renderedInner = true;
-                    }
-                    DrawGhostBlock(renderGroup, dragInfo.firstBlock->type, &innerLayout, &innerInnerLayout);
-                }
-                else {
-                    Invalid;
+        if (IsInsertionPoint(block, InsertionType_Inside)) {
+            if (IsSimpleBlockType(dragInfo->firstBlockType)) {
+                DrawGhostBlock(renderGroup, dragInfo->firstBlockType, &innerLayout);
+            }
+            else if (IsBranchBlockType(type)) {
+                // Override block drawing so that branch contains the rest of the substack
+                BlockMetrics *dragMetrics = &METRICS[dragInfo->firstBlockType]; // @TODO: Double-check this. Is this the right metrics to be grabbing here?
+                Layout innerInnerLayout = CreateEmptyLayoutAt(innerLayout.at.x + dragMetrics->innerOrigin.x, innerLayout.at.y);
+                if (links->inner.index && !dragInfo->firstBlockHasInner) {
+                    DrawSubScript(renderGroup, links->inner, script, &innerInnerLayout);
+                    renderedInner = true;
                 }
-                
-                blocksCtx->dragInfo.readyToInsert = true;
-                blocksCtx->dragInfo.insertionType = InsertionType_Inside;
-                blocksCtx->dragInfo.insertionBaseBlock = block;
-                blocksCtx->dragInfo.insertionBaseScript = script;
+                DrawGhostBlock(renderGroup, dragInfo->firstBlockType, &innerLayout, &innerInnerLayout);
+            }
+            else {
+                Invalid;
             }
         }
         
         // If we didn't already draw the entire inner script (i.e., with a ghost block)
         // then do it now, the normal way
-        if (block->inner && !renderedInner) {
-            DrawSubScript(renderGroup, block->inner, script, &innerLayout);
+        if (links->inner.index && !renderedInner) {
+            DrawSubScript(renderGroup, links->inner, script, &innerLayout);
         }
-        DrawBranchBlock(renderGroup, block->type, block, script, layout, &innerLayout);
+        DrawBranchBlock(renderGroup, type, block, script, layout, &innerLayout);
     }
     else {
         Invalid;
     }
     
     // Draw ghost block after this block, if necessary
-    if (Dragging() 
-        && dragInfo.script != script 
-        && !blocksCtx->dragInfo.readyToInsert
-        && HasOutlet(block->type)
-        && HasInlet(dragInfo.firstBlock->type))
-    {
-        BlockMetrics blockMetrics = METRICS[block->type];
-        Rectangle outletBounds = TranslateRectangle(blockMetrics.outlet, {layout->at.x - blockMetrics.size.w, layout->at.y});
-        // DEBUGPushRectOutline(outletBounds, COLOR_BLUE);
-        if (RectsIntersect(outletBounds, dragInfo.inlet)) {
-            if (IsSimpleBlockType(dragInfo.firstBlock->type)) {
-                DrawGhostBlock(renderGroup, dragInfo.firstBlock->type, layout);
-                
-                blocksCtx->dragInfo.readyToInsert = true;
-                blocksCtx->dragInfo.insertionType = InsertionType_After;
-                blocksCtx->dragInfo.insertionBaseBlock = block;
-                blocksCtx->dragInfo.insertionBaseScript = script;
-            }
-            else if (IsBranchBlockType(dragInfo.firstBlock->type)) {
-                if (dragInfo.script->topBlock->inner) {
-                    // If the loop already contains an inner stack, just put it in line
-                    DrawGhostBlock(renderGroup, dragInfo.firstBlock->type, layout);
-                    blocksCtx->dragInfo.readyToInsert = true;
-                    blocksCtx->dragInfo.insertionType = InsertionType_After;
-                    blocksCtx->dragInfo.insertionBaseBlock = block;
-                    blocksCtx->dragInfo.insertionBaseScript = script;
-                }
-                else {
-                    // Otherwise, override block drawing so that loop contains the rest of the substack
-                    BlockMetrics dragMetrics = METRICS[dragInfo.firstBlock->type];
-                    Layout innerLayout = CreateEmptyLayoutAt(layout->at.x + dragMetrics.innerOrigin.x, layout->at.y);
-                    blocksCtx->dragInfo.readyToInsert = true; // Set this here so that the inner substack doesn't also try to draw a ghost block
-                    if (block->next) {
-                        DrawSubScript(renderGroup, block->next, script, &innerLayout);
-                    }
-                    DrawGhostBlock(renderGroup, dragInfo.firstBlock->type, layout, &innerLayout);
-                    blocksCtx->dragInfo.readyToInsert = true;
-                    blocksCtx->dragInfo.insertionType = InsertionType_After;
-                    blocksCtx->dragInfo.insertionBaseBlock = block;
-                    blocksCtx->dragInfo.insertionBaseScript = script;
-                    
-                    // @TODO: I don't love this weird return boolean thing. Is there a way to avoid this?
-                    return false; // Don't continue drawing this substack
-                }
-            }
-            else {
-                Invalid;
+    if (IsInsertionPoint(block, InsertionType_After)) {
+        if (IsSimpleBlockType(dragInfo->firstBlockType) || dragInfo->firstBlockHasInner) {
+            // If the dragged loop already contains an inner stack, just put it in line
+            DrawGhostBlock(renderGroup, dragInfo->firstBlockType, layout);
+        }
+        else if (IsBranchBlockType(dragInfo->firstBlockType)) {
+            // Otherwise, override block drawing so that loop contains the rest of the substack
+            BlockMetrics *dragMetrics = &METRICS[dragInfo->firstBlockType];
+            Layout innerLayout = CreateEmptyLayoutAt(layout->at.x + dragMetrics->innerOrigin.x, layout->at.y);
+            if (links->next.index) {
+                DrawSubScript(renderGroup, links->next, script, &innerLayout);
             }
+            DrawGhostBlock(renderGroup, dragInfo->firstBlockType, layout, &innerLayout);
+            
+            // @TODO: I don't love this weird return boolean thing. Is there a way to avoid this?
+            return false; // Don't continue drawing this substack
+        }
+        else {
+            Invalid;
         }
     }
     
     return true;
 }
 
-void DrawInput(RenderGroup *renderGroup, Block *block, RenderEntry *blockEntry, f32 xOffset = 0) {
-    switch (block->inputType) {
+void DrawInput(RenderGroup *renderGroup, BlockType blockType, BlockInput *input, RenderEntry *blockEntry, f32 xOffset = 0) {
+    switch (input->type) {
         case BlockInputType_Number: {
-            BlockMetrics metrics = METRICS[block->type];
-            v2 inputP = blockEntry->P + metrics.inputOrigin;
+            BlockMetrics *metrics = &METRICS[blockType];
+            v2 inputP = blockEntry->P + metrics->inputOrigin;
             inputP.x += xOffset;
-            RenderInput(renderGroup, block->inputType, inputP, COLOR_WHITE, blockEntry->outline);
+            RenderInput(renderGroup, input->type, inputP, COLOR_WHITE, blockEntry->outline);
             
             char *blockText = NULL;
-            if(IsInteger(block->inputNumber)) {
-                blockText = PushFormattedText(&blocksCtx->frame, "%0.f", block->inputNumber);
+            if(IsInteger(input->number)) {
+                blockText = PushFormattedText(&blocksCtx->scratch, "%0.f", input->number);
             }
             else {
-                blockText = PushFormattedText(&blocksCtx->frame, "%0.2f", block->inputNumber);
+                blockText = PushFormattedText(&blocksCtx->scratch, "%0.2f", input->number);
             }
             
             f32 textHeight = 4.0; // Block units
@@ -873,22 +2492,22 @@ void DrawInput(RenderGroup *renderGroup, Block *block, RenderEntry *blockEntry,
             v2 baselineCenter = inputP + v2{6, 2.75};
             v2 textP = baselineCenter - v2{bounds.w / 2.0f, 0};
             v4 color = SCRATCH_COLORS[SCRATCH_COLOR_TEXT];
-            RenderText(&blocksCtx->fontRenderGroup, blockText, textP, textHeight, color, color);
+            RenderText(renderGroup, blockText, textP, textHeight, color, color);
             
             break;
         }
         case BlockInputType_Text: {
-            BlockMetrics metrics = METRICS[block->type];
-            v2 inputP = blockEntry->P + metrics.inputOrigin;
+            BlockMetrics *metrics = &METRICS[blockType];
+            v2 inputP = blockEntry->P + metrics->inputOrigin;
             inputP.x += xOffset;
-            RenderInput(renderGroup, block->inputType, inputP, COLOR_WHITE, blockEntry->outline);
+            RenderInput(renderGroup, input->type, inputP, COLOR_WHITE, blockEntry->outline);
             
             f32 textHeight = 4.0; // Block units
-            v2 bounds = BoundsForText(block->inputText, textHeight);
+            v2 bounds = BoundsForText(input->text->text, textHeight);
             v2 baselineCenter = inputP + v2{6, 2.75};
             v2 textP = baselineCenter - v2{bounds.w / 2.0f, 0};
             v4 color = SCRATCH_COLORS[SCRATCH_COLOR_TEXT];
-            RenderText(&blocksCtx->fontRenderGroup, block->inputText, textP, textHeight, color, color);
+            RenderText(renderGroup, input->text->text, textP, textHeight, color, color);
             
             break;
         }
@@ -896,24 +2515,34 @@ void DrawInput(RenderGroup *renderGroup, Block *block, RenderEntry *blockEntry,
     }
 }
 
-void DrawSimpleBlock(RenderGroup *renderGroup, BlockType blockType, Block *block, Script *script, Layout *layout, u32 flags) {
+void DrawSimpleBlock(RenderGroup *renderGroup, BlockType blockType, BlockHandle block, Script *script, Layout *layout, u32 flags) {
     b32 isGhost = flags & DrawBlockFlags_Ghost;
-    if (block) {
-        Assert(blockType == block->type);
+    if (block.index) {
+        Assert(blockType == GetBlockType(block));
         Assert(IsSimpleBlockType(blockType));
     }
     else {
         Assert(isGhost);
     }
     
-    BlockMetrics metrics = METRICS[blockType];
+    BlockMetrics *metrics = &METRICS[blockType];
+    
+    Rectangle hitBox = { layout->at.x, layout->at.y, metrics->size.w, metrics->size.h};
+    
+    layout->at.x += metrics->size.w;
     
-    Rectangle hitBox = { layout->at.x, layout->at.y, metrics.size.w, metrics.size.h};
+    layout->bounds.w += metrics->size.w;
+    layout->bounds.h = Max(layout->bounds.h, metrics->size.h);
+    
+    if (!RectsIntersect(hitBox, renderGroup->cullBounds)) {
+        // Off screen. It still takes up room in the layout, which is all anyone else needs from it.
+        return;
+    }
     
     RenderEntry *entry = PushRenderEntry(renderGroup);
     entry->type = RenderEntryTypeForBlockType(blockType);
     entry->block = block;
-    entry->P = v2{layout->at.x, layout->at.y};
+    entry->P = hitBox.origin;
     if (isGhost) {
         entry->color = v4{1, 1, 1, 0.5};
         entry->outline = v4{1, 1, 1, 0.5};
@@ -924,54 +2553,61 @@ void DrawSimpleBlock(RenderGroup *renderGroup, BlockType blockType, Block *block
     }
     entry->scale = 1.0f;
     
-    if (!isGhost && block->inputType) {
-        DrawInput(renderGroup, block, entry);
+    if (!isGhost) {
+        BlockInput *input = GetBlockInput(block);
+        if (input->type) {
+            DrawInput(renderGroup, blockType, input, entry);
+        }
     }
     
-    
-    layout->at.x += metrics.size.w;
-
-    layout->bounds.w += metrics.size.w;
-    layout->bounds.h = Max(layout->bounds.h, metrics.size.h);
-    
-    if (!isGhost && PointInRect(renderGroup->mouseP, hitBox)) {
+    if (!isGhost && script->pickFrame == blocksCtx->frameIndex && PointInRect(renderGroup->mouseP, hitBox)) {
         blocksCtx->nextHot.type = InteractionType_BlockSelect;
         blocksCtx->nextHot.block = block;
         blocksCtx->nextHot.blockP = entry->P;
-        blocksCtx->nextHot.script = script;
+        blocksCtx->nextHot.script = script->handle;
         blocksCtx->nextHot.entry = entry;
         blocksCtx->nextHot.mouseStartP = renderGroup->mouseP;
         blocksCtx->nextHot.mouseOffset = { renderGroup->mouseP.x - script->P.x, renderGroup->mouseP.y - script->P.y };
     }
 }
 
-void DrawBranchBlock(RenderGroup *renderGroup, BlockType blockType, Block *block, Script *script, Layout *layout, Layout *innerLayout, u32 flags) {
+void DrawBranchBlock(RenderGroup *renderGroup, BlockType blockType, BlockHandle block, Script *script, Layout *layout, Layout *innerLayout, u32 flags) {
     b32 isGhost = flags & DrawBlockFlags_Ghost;
-    if (block) {
-        Assert(blockType == block->type);
+    if (block.index) {
+        Assert(blockType == GetBlockType(block));
         Assert(IsBranchBlockType(blockType));
     }
     else {
         Assert(isGhost);
     }
     
-    BlockMetrics metrics = METRICS[blockType];
+    BlockMetrics *metrics = &METRICS[blockType];
     
     u32 horizStretch = 0;
     u32 vertStretch = 0;
     if (innerLayout) {
-        horizStretch = Max(innerLayout->bounds.w - metrics.innerSize.w, 0);
-        vertStretch = Max(innerLayout->bounds.h - metrics.innerSize.h, 0);
+        horizStretch = Max(innerLayout->bounds.w - metrics->innerSize.w, 0);
+        vertStretch = Max(innerLayout->bounds.h - metrics->innerSize.h, 0);
     }
     
         
-    Rectangle hitBox = { layout->at.x, layout->at.y, metrics.size.w + (f32)horizStretch, metrics.size.h + (f32)vertStretch };
-    Rectangle innerHitBox = { layout->at.x + metrics.innerOrigin.x, layout->at.y, metrics.innerSize.w + (f32)horizStretch, metrics.innerSize.h + (f32)vertStretch };
+    Rectangle hitBox = { layout->at.x, layout->at.y, metrics->size.w + (f32)horizStretch, metrics->size.h + (f32)vertStretch };
+    Rectangle innerHitBox = { layout->at.x + metrics->innerOrigin.x, layout->at.y, metrics->innerSize.w + (f32)horizStretch, metrics->innerSize.h + (f32)vertStretch };
+    
+    layout->at.x += metrics->size.w + horizStretch;
+    
+    layout->bounds.w += metrics->size.w + horizStretch;
+    layout->bounds.h = Max(layout->bounds.h, metrics->size.h + vertStretch);
+    
+    if (!RectsIntersect(hitBox, renderGroup->cullBounds)) {
+        // Off screen. The inner stack has already been laid out (and culled) on its own.
+        return;
+    }
     
     RenderEntry *entry = PushRenderEntry(renderGroup);
     entry->type = RenderEntryTypeForBlockType(blockType);
     entry->block = block;
-    entry->P = v2{layout->at.x, layout->at.y};
+    entry->P = hitBox.origin;
     if (isGhost) {
         entry->color = v4{1, 1, 1, 0.5};
         entry->outline = v4{1, 1, 1, 0.5};
@@ -983,20 +2619,19 @@ void DrawBranchBlock(RenderGroup *renderGroup, BlockType blockType, Block *block
     entry->hStretch = horizStretch;
     entry->vStretch = vertStretch;
     
-    layout->at.x += metrics.size.w + horizStretch;
-    
-    layout->bounds.w += metrics.size.w + horizStretch;
-    layout->bounds.h = Max(layout->bounds.h, metrics.size.h + vertStretch);
-    
-    if (!isGhost && block->inputType) {
-        DrawInput(renderGroup, block, entry, horizStretch);
+    if (!isGhost) {
+        BlockInput *input = GetBlockInput(block);
+        if (input->type) {
+            DrawInput(renderGroup, blockType, input, entry, horizStretch);
+        }
     }
     
-    if (!isGhost && PointInRect(renderGroup->mouseP, hitBox) && !PointInRect(renderGroup->mouseP, innerHitBox)) {
+    if (!isGhost && script->pickFrame == blocksCtx->frameIndex
+        && PointInRect(renderGroup->mouseP, hitBox) && !PointInRect(renderGroup->mouseP, innerHitBox)) {
         blocksCtx->nextHot.type = InteractionType_BlockSelect;
         blocksCtx->nextHot.block = block;
         blocksCtx->nextHot.blockP = entry->P;
-        blocksCtx->nextHot.script = script;
+        blocksCtx->nextHot.script = script->handle;
         blocksCtx->nextHot.entry = entry;
         blocksCtx->nextHot.mouseStartP = renderGroup->mouseP;
         blocksCtx->nextHot.mouseOffset = { renderGroup->mouseP.x - script->P.x, renderGroup->mouseP.y - script->P.y };
@@ -1005,10 +2640,10 @@ void DrawBranchBlock(RenderGroup *renderGroup, BlockType blockType, Block *block
 
 void DrawGhostBlock(RenderGroup *renderGroup, BlockType blockType, Layout *layout, Layout *innerLayout) {
     if (IsSimpleBlockType(blockType)) {
-        DrawSimpleBlock(renderGroup, blockType, NULL, NULL, layout, DrawBlockFlags_Ghost);
+        DrawSimpleBlock(renderGroup, blockType, {}, NULL, layout, DrawBlockFlags_Ghost);
     }
     else if (IsBranchBlockType(blockType)) {
-        DrawBranchBlock(renderGroup, blockType, NULL, NULL, layout, innerLayout, DrawBlockFlags_Ghost);
+        DrawBranchBlock(renderGroup, blockType, {}, NULL, layout, innerLayout, DrawBlockFlags_Ghost);
     }
     else {
         Invalid;
@@ -1016,10 +2651,28 @@ void DrawGhostBlock(RenderGroup *renderGroup, BlockType blockType, Layout *layou
 }
 
 
-extern "C" void InitBlocks(void *mem, u32 memSize) {
-    static const u32 VERTS_MEM_SIZE = 65535 * VERTEX_SIZE;
+// Makes context current for this thread and returns the one it replaced, so an entry point called
+// from inside another (say, from a budget callback) hands the outer context back when it's done
+internal inline
+BlocksContext *EnterContext(BlocksContext *context) {
+    Assert(context);
+    BlocksContext *previous = blocksCtx;
+    blocksCtx = context;
+    return previous;
+}
+
+internal inline
+void LeaveContext(BlocksContext *previous) {
+    blocksCtx = previous;
+}
+
+internal
+BlocksContext *InitBlocksContext(void *mem, umm memSize, BlocksAllocator *allocator) {
+    // Rounded up so the arenas carved out after it stay 16-byte aligned whatever the vertex size
+    static const umm VERTS_MEM_SIZE = AlignDown(65535 * VERTEX_SIZE + QUAD_INDEX_SIZE(65535) + 15, 16);
+    static const umm SCRATCH_MEM_SIZE = Kilobytes(256);
     
-    Assert(memSize >= sizeof(BlocksContext) + VERTS_MEM_SIZE);
+    Assert(memSize >= sizeof(BlocksContext));
     
     Arena dummyArena = {};
     dummyArena.data = (u8 *)mem;
@@ -1027,216 +2680,397 @@ extern "C" void InitBlocks(void *mem, u32 memSize) {
     dummyArena.used = 0;
     
     BlocksContext *context = PushStruct(&dummyArena, BlocksContext);
-    u32 permanentArenaSize = dummyArena.size - dummyArena.used - VERTS_MEM_SIZE;
+    memset(context, 0, sizeof(BlocksContext)); // Hosts don't have to hand us zeroed memory
+    umm remainingSize = dummyArena.size - dummyArena.used;
+    
+    umm frameArenaSize = VERTS_MEM_SIZE;
+    umm scratchArenaSize = SCRATCH_MEM_SIZE;
+    if (allocator) {
+        // All of the arenas can grow, so just split whatever we were given
+        context->allocator = *allocator;
+        dummyArena.allocator = &context->allocator;
+        dummyArena.minChunkSize = ARENA_MIN_CHUNK_SIZE;
+        frameArenaSize = AlignDown(Min(VERTS_MEM_SIZE, remainingSize / 2), 16);
+        scratchArenaSize = AlignDown(Min(SCRATCH_MEM_SIZE, remainingSize / 4), 16);
+    }
+    else {
+        Assert(remainingSize >= VERTS_MEM_SIZE + SCRATCH_MEM_SIZE);
+        // Render entries come out of scratch, so give it a bigger share when there's plenty to go around
+        umm scratchShare = AlignDown((remainingSize - frameArenaSize) / 4, 16);
+        scratchArenaSize = Max(SCRATCH_MEM_SIZE, scratchShare);
+    }
+    // Block storage is the bulk of long-lived memory, so the workspace gets most of what's left
+    umm longLivedSize = remainingSize - frameArenaSize - scratchArenaSize;
+    umm permanentArenaSize = AlignDown(longLivedSize / 4, 16); // Keeps the arenas after it aligned
+    umm workspaceArenaSize = longLivedSize - permanentArenaSize;
     
     context->permanent = SubArena(&dummyArena, permanentArenaSize);
-    context->frame = SubArena(&dummyArena, VERTS_MEM_SIZE);
+    context->frame = SubArena(&dummyArena, frameArenaSize);
+    context->scratch = SubArena(&dummyArena, scratchArenaSize);
+    context->workspace = SubArena(&dummyArena, workspaceArenaSize);
+    
+    InitStringTable(&context->strings, &context->permanent);
+    
+    InitScriptGrid(&context->scriptGrid, &context->permanent);
+    
+    BuildBlockTemplates(&context->blockTemplates, &context->permanent);
     
     context->scriptCount = 0;
     
     context->zoomLevel = 3.0f;
     context->cameraOrigin = v2{0, 0};
     
-    blocksCtx = context;
+    BlocksContext *previousCtx = EnterContext(context);
     
     // Create some blocks, y'know, for fun
     {
         // A script with a single command block
-        Script *script = CreateScript(v2{-40, 0});
-        Block *block = CreateBlock(BlockType_Command);
-        script->topBlock = block;
+        BlockHandle block = CreateBlock(BlockType_Command);
+        CreateScript(v2{-40, 0}, block);
     }
     
     {
         // A script with a single command block, with a number input
-        Script *script = CreateScript(v2{-20, 0});
-        Block *block = CreateBlock(BlockType_Command);
-        block->inputType = BlockInputType_Number;
-        block->inputNumber = 25.93f;
-        script->topBlock = block;
+        BlockHandle block = CreateBlock(BlockType_Command);
+        SetBlockInputNumber(block, 25.93f);
+        CreateScript(v2{-20, 0}, block);
     }
     
     {
         // A script with a single command block, with a text input
-        Script *script = CreateScript(v2{0, 0});
-        Block *block = CreateBlock(BlockType_Command);
-        block->inputType = BlockInputType_Text;
-        block->inputText = PushText(&blocksCtx->permanent, "Hey!");
-        script->topBlock = block;
+        BlockHandle block = CreateBlock(BlockType_Command);
+        SetBlockInputText(block, "Hey!");
+        CreateScript(v2{0, 0}, block);
     }
     
     {
         // A loop block with a number input
-        Script *script = CreateScript(v2{20, 0});
-        Block *block = CreateBlock(BlockType_Loop);
-        block->inputType = BlockInputType_Number;
-        block->inputNumber = 10;
-        script->topBlock = block;
+        BlockHandle block = CreateBlock(BlockType_Loop);
+        SetBlockInputNumber(block, 10);
+        CreateScript(v2{20, 0}, block);
     }
     
     {
         // An event block with a number input
-        Script *script = CreateScript(v2{60, 0});
-        Block *block = CreateBlock(BlockType_Event);
-        block->inputType = BlockInputType_Number;
-        block->inputNumber = 10;
-        script->topBlock = block;
+        BlockHandle block = CreateBlock(BlockType_Event);
+        SetBlockInputNumber(block, 10);
+        CreateScript(v2{60, 0}, block);
     }
     
     {
         // An end cap block with a number input
-        Script *script = CreateScript(v2{80, 0});
-        Block *block = CreateBlock(BlockType_EndCap);
-        block->inputType = BlockInputType_Number;
-        block->inputNumber = 10;
-        script->topBlock = block;
+        BlockHandle block = CreateBlock(BlockType_EndCap);
+        SetBlockInputNumber(block, 10);
+        CreateScript(v2{80, 0}, block);
     }
     
     {
         // A script with some different types of blocks
-        Script *script = CreateScript(v2{-40, -25});
-        Block *event = CreateBlock(BlockType_Event);
-        script->topBlock = event;
+        BlockHandle event = CreateBlock(BlockType_Event);
+        CreateScript(v2{-40, -25}, event);
         
-        Block *command = CreateBlock(BlockType_Command);
+        BlockHandle command = CreateBlock(BlockType_Command);
         Connect(event, command);
         
-        Block *repeat = CreateBlock(BlockType_Loop);
+        BlockHandle repeat = CreateBlock(BlockType_Loop);
         Connect(command, repeat);
         
-        Block *forever = CreateBlock(BlockType_Forever);
+        BlockHandle forever = CreateBlock(BlockType_Forever);
         Connect(repeat, forever);
     }
     
     {
         // Same as previous, but with an end cap instead of a forever at the end
-        Script *script = CreateScript(v2{-40, -50});
-        Block *event = CreateBlock(BlockType_Event);
-        script->topBlock = event;
+        BlockHandle event = CreateBlock(BlockType_Event);
+        CreateScript(v2{-40, -50}, event);
         
-        Block *command = CreateBlock(BlockType_Command);
+        BlockHandle command = CreateBlock(BlockType_Command);
         Connect(event, command);
         
-        Block *repeat = CreateBlock(BlockType_Loop);
+        BlockHandle repeat = CreateBlock(BlockType_Loop);
         Connect(command, repeat);
         
-        Block *endCap = CreateBlock(BlockType_EndCap);
+        BlockHandle endCap = CreateBlock(BlockType_EndCap);
         Connect(repeat, endCap);
     }
     
     {
         // A script with three blocks in a row
-        Script *script = CreateScript(v2{40, -30});
-        Block *topBlock = CreateBlock(BlockType_Command);
-        script->topBlock = topBlock;
+        BlockHandle topBlock = CreateBlock(BlockType_Command);
+        CreateScript(v2{40, -30}, topBlock);
         
-        Block *loop = CreateBlock(BlockType_Loop);
+        BlockHandle loop = CreateBlock(BlockType_Loop);
         Connect(topBlock, loop);
         
-        Block *block2 = CreateBlock(BlockType_Command);
+        BlockHandle block2 = CreateBlock(BlockType_Command);
         Connect(loop, block2);
     }
     
     
     {
         // A script with nested loops
-        Script *script = CreateScript(v2{-30, 50});
-        Block *block1 = CreateBlock(BlockType_Command);
-        script->topBlock = block1;
+        BlockHandle block1 = CreateBlock(BlockType_Command);
+        CreateScript(v2{-30, 50}, block1);
         
-        Block *outerLoop = CreateBlock(BlockType_Loop);
+        BlockHandle outerLoop = CreateBlock(BlockType_Loop);
         Connect(block1, outerLoop);
         
-            Block *block2 = CreateBlock(BlockType_Command);
-            Block *innerLoop = CreateBlock(BlockType_Loop);
-            Block *block3 = CreateBlock(BlockType_Command);
+            BlockHandle block2 = CreateBlock(BlockType_Command);
+            BlockHandle innerLoop = CreateBlock(BlockType_Loop);
+            BlockHandle block3 = CreateBlock(BlockType_Command);
             
             Connect(block2, innerLoop);
             Connect(innerLoop, block3);
         
         ConnectInner(outerLoop, block2);
         
-        Block *last = CreateBlock(BlockType_Command);
+        BlockHandle last = CreateBlock(BlockType_Command);
         Connect(outerLoop, last);
     }
     
     // {
     //     // A script with a bunch of nested loops
-    //     Script *script = CreateScript(v2{0, -60});
-    //     Block *current = CreateBlock(BlockType_Loop);
-    //     script->topBlock = current;
+    //     BlockHandle current = CreateBlock(BlockType_Loop);
+    //     CreateScript(v2{0, -60}, current);
         
     //     for (int i = 0; i < 10; ++i) {
-    //         Block *inner = CreateBlock(BlockType_Loop);
+    //         BlockHandle inner = CreateBlock(BlockType_Loop);
     //         ConnectInner(current, inner);
     //         current = inner;
     //     }
     // }
     
+    LeaveContext(previousCtx);
+    return context;
+}
+
+extern "C" BlocksContext *InitBlocks(void *mem, umm memSize) {
+    return InitBlocksContext(mem, memSize, NULL);
+}
+
+// Like InitBlocks(), but the arenas grow by requesting more memory from the host instead of running out
+extern "C" BlocksContext *InitBlocksWithAllocator(void *mem, umm memSize, BlocksAllocator allocator) {
+    Assert(allocator.allocate && allocator.free);
+    return InitBlocksContext(mem, memSize, &allocator);
+}
+
+BlocksUsage UsageForArena(Arena *arena) {
+    UpdateArenaHighWater(arena);
+    
+    BlocksUsage result = {};
+    result.current = ArenaTotalUsed(arena);
+    result.highWater = arena->highWater;
+    result.reserved = ArenaTotalSize(arena);
+    result.capacity = arena->allocator ? 0 : arena->size;
+    return result;
+}
+
+BlocksUsage UsageForRenderGroup(RenderGroup *group) {
+    BlocksUsage result = {};
+    result.current = group->entryCount;
+    result.highWater = Max(group->highWaterCount, group->entryCount);
+    result.reserved = group->reservedCount;
+    result.capacity = 0;
+    return result;
+}
+
+BlocksUsage UsageForBlockStore(BlockStore *store) {
+    BlocksUsage result = {};
+    result.current = store->count;
+    result.highWater = store->highWaterCount;
+    result.reserved = store->capacity;
+    result.capacity = 0;
+    return result;
+}
+
+void UpdateCountUsage(BlocksUsage *usage, umm current, umm capacity) {
+    usage->current = current;
+    usage->highWater = Max(usage->highWater, current);
+    usage->reserved = capacity;
+    usage->capacity = capacity;
+}
+
+void UpdateStats() {
+    BlocksStats *stats = &blocksCtx->stats;
+    
+    stats->permanentArena = UsageForArena(&blocksCtx->permanent);
+    stats->frameArena = UsageForArena(&blocksCtx->frame);
+    stats->scratchArena = UsageForArena(&blocksCtx->scratch);
+    stats->workspaceArena = UsageForArena(&blocksCtx->workspace);
+    
+    stats->blocksRenderGroup = UsageForRenderGroup(&blocksCtx->blocksRenderGroup);
+    stats->uiRenderGroup = UsageForRenderGroup(&blocksCtx->uiRenderGroup);
+    
+    stats->scripts.current = blocksCtx->scriptCount;
+    stats->scripts.highWater = Max(stats->scripts.highWater, blocksCtx->scriptCount);
+    stats->scripts.reserved = blocksCtx->scriptCapacity;
+    stats->scripts.capacity = 0;
+    stats->blocks = UsageForBlockStore(&blocksCtx->blockStore);
+    
+    StringTable *strings = &blocksCtx->strings;
+    stats->strings.current = strings->count;
+    stats->strings.highWater = Max(stats->strings.highWater, strings->count);
+    stats->strings.reserved = strings->bucketCount;
+    stats->strings.capacity = 0;
+}
+
+b32 IsOverBudget(BlocksUsage usage, f32 budgetFraction) {
+    if (!usage.capacity) {
+        return false;
+    }
+    return (f32)usage.current >= budgetFraction * (f32)usage.capacity;
+}
+
+void CheckBudgets() {
+    if (!blocksCtx->budgetCallback) {
+        return;
+    }
     
+    // @NOTE: Anything added to BlocksStats has to be added here too
+    BlocksStats *stats = &blocksCtx->stats;
+    BlocksUsage *usages[] = {
+        &stats->permanentArena,
+        &stats->frameArena,
+        &stats->scratchArena,
+        &stats->workspaceArena,
+        &stats->blocksRenderGroup,
+        &stats->uiRenderGroup,
+        &stats->scripts,
+        &stats->blocks,
+        &stats->strings,
+        &stats->drawCalls,
+    };
+    for (u32 i = 0; i < ArrayCount(usages); ++i) {
+        if (IsOverBudget(*usages[i], blocksCtx->budgetFraction)) {
+            blocksCtx->budgetCallback(stats, blocksCtx->budgetUserData);
+            return;
+        }
+    }
+}
+
+// Forces block storage to be put back in traversal order and compacted, e.g. after deleting a lot of blocks.
+// RunBlocks() also does both on its own, but only relocates once a good share of the blocks have been
+// edited out of order and the editor has been idle for RELOCATION_IDLE_FRAMES.
+extern "C" void CompactBlocksMemory(BlocksContext *context) {
+    BlocksContext *previousCtx = EnterContext(context);
+    RelocateBlocksInTraversalOrder();
+    CompactWorkspace();
+    LeaveContext(previousCtx);
+}
+
+extern "C" BlocksStats GetBlocksStats(BlocksContext *context) {
+    BlocksContext *previousCtx = EnterContext(context);
+    UpdateStats();
+    BlocksStats stats = blocksCtx->stats;
+    LeaveContext(previousCtx);
+    return stats;
+}
+
+// The callback fires at the end of any frame where some fixed-capacity resource is
+// at least budgetFraction full. Pass a NULL callback to turn it off.
+extern "C" void SetBlocksBudgetCallback(BlocksContext *context, BlocksBudgetFunc callback, f32 budgetFraction, void *userData) {
+    context->budgetCallback = callback;
+    context->budgetFraction = budgetFraction;
+    context->budgetUserData = userData;
 }
 
-extern "C" BlocksRenderInfo RunBlocks(void *mem, BlocksInput *input) {
-    // Always reset the blocksCtx pointer in case we reloaded the dylib
-    blocksCtx = (BlocksContext *)mem;
+extern "C" BlocksRenderInfo RunBlocks(BlocksContext *context, BlocksInput *input) {
+    // Always set the blocksCtx pointer, since a reloaded dylib starts out without one
+    BlocksContext *previousCtx = EnterContext(context);
     BeginBlocks(*input);
     
-    TransformPair blocksTransformPair = BlocksCameraTransformPair(blocksCtx->screenSize, blocksCtx->zoomLevel, blocksCtx->cameraOrigin);
+    // Housekeeping that moves blocks around. Only handles are held across frames, so this is safe
+    // at any point, but there's no sense in doing it over and over in the middle of a drag.
+    if (Interacting() || input->mouseDown || input->wheelDelta.x || input->wheelDelta.y) {
+        blocksCtx->idleFrameCount = 0;
+    }
+    else {
+        blocksCtx->idleFrameCount++;
+    }
+    if (!Interacting()) {
+        if (BlocksNeedRelocation()) {
+            RelocateBlocksInTraversalOrder();
+        }
+        if (VertexCacheNeedsRepack()) {
+            RepackVertexCache();
+        }
+        if (WorkspaceNeedsCompaction()) {
+            CompactWorkspace();
+        }
+    }
     
-    InitRenderGroup(&blocksCtx->debugRenderGroup, blocksTransformPair.transform, blocksTransformPair.invTransform);
+    TransformPair blocksTransformPair = BlocksCameraTransformPair(blocksCtx->screenSize, blocksCtx->zoomLevel, blocksCtx->cameraOrigin);
     
     RenderGroup *blocksRenderGroup = &blocksCtx->blocksRenderGroup;
-    InitRenderGroup(blocksRenderGroup, blocksTransformPair.transform, blocksTransformPair.invTransform);
-    
-    RenderGroup *dragRenderGroup = &blocksCtx->dragRenderGroup;
-    InitRenderGroup(dragRenderGroup, blocksTransformPair.transform, blocksTransformPair.invTransform);
+    InitRenderGroup(blocksRenderGroup, RenderLayer_Blocks, blocksTransformPair.transform, blocksTransformPair.invTransform);
     
-    RenderGroup *fontRenderGroup = &blocksCtx->fontRenderGroup;
-    InitRenderGroup(fontRenderGroup, blocksTransformPair.transform, blocksTransformPair.invTransform);
+    UpdateDirtyScripts();
     
     if (Dragging()) {
         // Update dragging info
-        Script *script = blocksCtx->dragInfo.script;
-        Block *firstBlock = blocksCtx->dragInfo.firstBlock;
-        Block *lastBlock = blocksCtx->dragInfo.lastBlock;
-        BlockMetrics firstMetrics = METRICS[firstBlock->type];
-        BlockMetrics lastMetrics = METRICS[lastBlock->type];
+        Script *script = GetScript(blocksCtx->dragInfo.script);
+        BlockType firstBlockType = GetBlockType(blocksCtx->dragInfo.firstBlock);
+        BlockType lastBlockType = GetBlockType(blocksCtx->dragInfo.lastBlock);
+        BlockMetrics *firstMetrics = &METRICS[firstBlockType];
+        BlockMetrics *lastMetrics = &METRICS[lastBlockType];
+        blocksCtx->dragInfo.firstBlockType = firstBlockType;
+        blocksCtx->dragInfo.lastBlockType = lastBlockType;
+        blocksCtx->dragInfo.firstBlockHasInner = GetBlockLinks(blocksCtx->dragInfo.firstBlock)->inner.index != 0;
         
-        Layout dragLayout = RenderScript(dragRenderGroup, script);
+        // Drawn first, to have its layout ready for snapping, but sorted on top of everything else
+        blocksRenderGroup->layer = RenderLayer_Drag;
+        Layout dragLayout = RenderScript(blocksRenderGroup, script);
+        blocksRenderGroup->layer = RenderLayer_Blocks;
+        UpdateScriptBounds(script, dragLayout.bounds);
         blocksCtx->dragInfo.scriptLayout = dragLayout;
         
         // DEBUGPushRectOutline(dragLayout.bounds, COLOR_GREEN);
         
-        if (HasInlet(firstBlock->type)) {
-            blocksCtx->dragInfo.inlet = TranslateRectangle(firstMetrics.inlet, dragLayout.bounds.origin);
+        if (HasInlet(firstBlockType)) {
+            blocksCtx->dragInfo.inlet = TranslateRectangle(firstMetrics->inlet, dragLayout.bounds.origin);
             // DEBUGPushRectOutline(blocksCtx->dragInfo.inlet, COLOR_CYAN);
         }
-        if (HasOutlet(lastBlock->type)) {
+        if (HasOutlet(lastBlockType)) {
             // Account for outlet offset in block metrics
-            blocksCtx->dragInfo.outlet = TranslateRectangle(lastMetrics.outlet, {dragLayout.at.x - lastMetrics.size.w, dragLayout.at.y});
+            blocksCtx->dragInfo.outlet = TranslateRectangle(lastMetrics->outlet, {dragLayout.at.x - lastMetrics->size.w, dragLayout.at.y});
             // DEBUGPushRectOutline(blocksCtx->dragInfo.outlet, COLOR_MAGENTA);
         }
-        if (HasInnerOutlet(firstBlock->type)) {
-            blocksCtx->dragInfo.innerOutlet = TranslateRectangle(firstMetrics.innerOutlet, dragLayout.bounds.origin);
+        if (HasInnerOutlet(firstBlockType)) {
+            blocksCtx->dragInfo.innerOutlet = TranslateRectangle(firstMetrics->innerOutlet, dragLayout.bounds.origin);
             // DEBUGPushRectOutline(blocksCtx->dragInfo.innerOutlet, COLOR_YELLOW);
         }
         
-        // Reset this to false each frame so we can update the ghost block insertion point, if necessary
-        blocksCtx->dragInfo.readyToInsert = false;
+        // Update the ghost block insertion point, if necessary
+        FindSnapTarget();
     }
-    for (u32 i = 0; i < blocksCtx->scriptCount; ++i) {
-        Script *script = &blocksCtx->scripts[i];
-        if (Dragging() && blocksCtx->dragInfo.script == script) {
+    
+    // Only scripts the grid puts on screen get laid out, and only the ones under the mouse get hit tested
+    ScriptDrawList drawList = {};
+    AddScriptsInRect(&drawList, blocksRenderGroup->cullBounds);
+    MarkScriptsUnderPoint(blocksRenderGroup->mouseP);
+    
+    // Keep drawing in script order, so overlapping scripts stack (and pick) the same way they always have
+    RadixSort(drawList.slots, drawList.count, &blocksCtx->scratch);
+    for (u32 i = 0; i < drawList.count; ++i) {
+        Script *script = &blocksCtx->scripts[drawList.slots[i]];
+        if (Dragging() && blocksCtx->dragInfo.script == script->handle) {
             continue;
         }
-        RenderScript(blocksRenderGroup, script);
+        DrawScript(script);
     }
     
     // Floating UI
     RenderGroup *overlayRenderGroup = &blocksCtx->uiRenderGroup;
     TransformPair oneToOneTransformPair = OneToOneCameraTransformPair(blocksCtx->screenSize);
-    InitRenderGroup(overlayRenderGroup, oneToOneTransformPair.transform, oneToOneTransformPair.invTransform);
+    InitRenderGroup(overlayRenderGroup, RenderLayer_UI, oneToOneTransformPair.transform, oneToOneTransformPair.invTransform);
     RenderNewBlockButton(overlayRenderGroup);
     
-    return EndBlocks();
+    BlocksRenderInfo renderInfo = EndBlocks();
+    
+    UpdateStats();
+    UpdateCountUsage(&blocksCtx->stats.drawCalls, renderInfo.drawCallCount, 0);
+    CheckBudgets();
+    
+    LeaveContext(previousCtx);
+    return renderInfo;
 }
@@ -30,26 +30,160 @@ struct BlocksInput {
     b32 commandDown;
 };
 
+// Block shapes and text are drawn from one single-channel SDF atlas, so every draw call uses the
+// same texture. Hosts build it from the block atlas (256x256, at x = 0) and the font atlas
+// (256x256, at x = BLOCKS_ATLAS_FONT_X).
+#define BLOCKS_ATLAS_WIDTH  512
+#define BLOCKS_ATLAS_HEIGHT 256
+#define BLOCKS_ATLAS_FONT_X 256
+
+// One vertex of BlocksRenderInfo::vertexData. Building both IMBlocks and the host with
+// BLOCKS_COMPACT_VERTICES defined swaps the all-float layout for one less than half the size,
+// with unorm16 UVs and RGBA8 colors. Hosts should take offsets and the stride from this struct.
+#ifdef BLOCKS_COMPACT_VERTICES
+struct BlocksVertex {
+    v2 P;
+    u16 uv[2];
+    u8 color[4];
+    u8 outline[4];
+};
+#else
+struct BlocksVertex {
+    v2 P;
+    v2 uv;
+    v4 color;
+    v4 outline;
+};
+#endif
+
+// Building with BLOCKS_INSTANCED_BLOCKS defined sends blocks and their inputs as one instance
+// apiece instead of as vertices, and text as one instance per character. Each instance is drawn as templateVertexStride vertices of its
+// template (the tail is padded with degenerate triangles), each one placed at
+//     (offset * scale + P) + (stretch * instance stretch)
+// with the template's UVs and the instance's colors. ExpandBlocksInstances() does the same on the CPU.
+#ifdef BLOCKS_COMPACT_VERTICES
+struct BlocksTemplateVertex {
+    v2 offset;
+    v2 stretch;
+    u16 uv[2];
+};
+
+struct BlocksInstance {
+    v2 P;
+    v2 stretch;
+    f32 scale;
+    u32 templateIndex;
+    u8 color[4];
+    u8 outline[4];
+};
+#else
+struct BlocksTemplateVertex {
+    v2 offset;
+    v2 stretch;
+    v2 uv;
+};
+
+struct BlocksInstance {
+    v2 P;
+    v2 stretch;
+    f32 scale;
+    u32 templateIndex;
+    v4 color;
+    v4 outline;
+};
+#endif
+
 struct BlocksDrawCall {
     mat4x4 transform;
-    u32 vertexCount;
-    u32 vertexOffset;
+    umm vertexCount;
+    umm vertexOffset;
+    
+    // Only set in BLOCKS_INDEXED_QUADS builds. Indices count from vertexOffset, so draw
+    // with it as the base vertex.
+    umm indexCount;
+    umm indexOffset;
+    
+    // Only set in BLOCKS_INSTANCED_BLOCKS builds. Draw these before the vertices.
+    umm instanceCount;
+    umm instanceOffset;
 };
 
 struct BlocksRenderInfo {
     u8 *vertexData;
-    u32 vertexDataSize;
+    umm vertexDataSize;
     
-    BlocksDrawCall drawCalls[16];
+    // Building with BLOCKS_INDEXED_QUADS defined emits four vertices per quad instead of six,
+    // along with triangle list indices that are indexSize (2 or 4) bytes each
+    u8 *indexData;
+    umm indexDataSize;
+    u32 indexSize;
+    
+    // Only set in BLOCKS_INSTANCED_BLOCKS builds. The templates don't change after InitBlocks.
+    BlocksInstance *instanceData;
+    umm instanceDataSize;
+    BlocksTemplateVertex *templateVertices;
+    u32 *templateVertexCounts; // Not counting the padding
+    u32 templateVertexStride;
+    u32 templateCount;
+    
+    // In the frame arena, like the vertices, so only good until the next RunBlocks()
+    BlocksDrawCall *drawCalls;
     u32 drawCallCount;
 };
 
+// Optional host callbacks for growing IMBlocks' memory past the block passed to InitBlocks
+typedef void *(*BlocksAllocateFunc)(umm size);
+typedef void (*BlocksFreeFunc)(void *mem, umm size);
+
+struct BlocksAllocator {
+    BlocksAllocateFunc allocate;
+    BlocksFreeFunc free;
+};
+
+// How much of a resource is in use. For arenas these are bytes, for everything else they're entry counts.
+struct BlocksUsage {
+    umm current;
+    umm highWater;
+    umm reserved;  // Currently allocated, including free space
+    umm capacity;  // Hard limit that IMBlocks asserts on, or 0 if the resource can grow
+};
+
+struct BlocksStats {
+    BlocksUsage permanentArena;
+    BlocksUsage frameArena;
+    BlocksUsage scratchArena;
+    BlocksUsage workspaceArena;
+    
+    BlocksUsage blocksRenderGroup;
+    BlocksUsage uiRenderGroup;
+    
+    BlocksUsage scripts;
+    BlocksUsage blocks;
+    BlocksUsage strings;
+    BlocksUsage drawCalls;
+};
+
+// Called at the end of a frame when any fixed-capacity resource is at or above its budget
+typedef void (*BlocksBudgetFunc)(const BlocksStats *stats, void *userData);
+
+// Opaque handle to everything one editor owns. It lives at the start of the memory passed to
+// InitBlocks, so a host can hold on to it across dylib reloads. Contexts share nothing, and
+// different contexts can be run from different threads at the same time.
+typedef struct BlocksContext BlocksContext;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
     
-void InitBlocks(void *mem, u32 memSize);
-BlocksRenderInfo RunBlocks(void *mem, BlocksInput *input);
+BlocksContext *InitBlocks(void *mem, umm memSize);
+BlocksContext *InitBlocksWithAllocator(void *mem, umm memSize, BlocksAllocator allocator);
+BlocksRenderInfo RunBlocks(BlocksContext *context, BlocksInput *input);
+void CompactBlocksMemory(BlocksContext *context);
+
+BlocksStats GetBlocksStats(BlocksContext *context);
+void SetBlocksBudgetCallback(BlocksContext *context, BlocksBudgetFunc callback, f32 budgetFraction, void *userData);
+
+u32 ExpandBlocksInstances(const BlocksRenderInfo *renderInfo, const BlocksDrawCall *drawCall, BlocksVertex *out);
 
 #ifdef __cplusplus
 }
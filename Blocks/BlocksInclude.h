@@ -23,3 +23,7 @@ void FormatString(char *buffer, const char *formatStr, va_list args) {
 f32 Ceil(f32 num) {
     return ceilf(num);
 }
+
+f32 Floor(f32 num) {
+    return floorf(num);
+}
@@ -8,10 +8,37 @@
 *
 **********************************************************/
 
-struct Block;
 struct Script;
 struct Layout;
 
+// Blocks and scripts are referred to by generational handles instead of pointers, so the storage
+// behind them is free to move (see CompactWorkspace()). Entry 0 is never handed out, so a zeroed
+// handle is null. A handle whose generation doesn't match its entry points at a deleted object.
+//
+// Pointers from GetBlockLinks()/GetScript() etc. are only good until the next create, delete or compaction.
+struct BlockHandle {
+    u32 index;
+    u32 generation;
+};
+
+struct ScriptHandle {
+    u32 index;
+    u32 generation;
+};
+
+struct HandleEntry {
+    u32 generation;
+    u32 slot; // Index into the dense storage while in use, next free entry while free
+};
+
+struct HandleTable {
+    HandleEntry *entries;
+    u32 count;
+    u32 capacity;
+    u32 firstFree;
+    u32 freeCount;
+};
+
 enum BlockType {
     BlockType_Command = 0,
     BlockType_Event,
@@ -22,10 +49,54 @@ enum BlockType {
     BlockTypeCount
 };
 
+// Header at the start of every chunk a growable arena gets from the host allocator.
+// It remembers the chunk that was current before it, so the chunks form a stack.
+struct ArenaChunk {
+    u8 *prevData;
+    umm prevSize;
+    umm prevUsed;
+    ArenaChunk *prevChunk;
+};
+
 struct Arena {
     u8 *data;
-    u32 size;
-    u32 used;
+    umm size;
+    umm used;
+    
+    // Only set for growable arenas. Fixed arenas assert when they run out of space.
+    BlocksAllocator *allocator;
+    ArenaChunk *chunk; // Current chunk, or 0 while we're still in the initial block of memory
+    umm minChunkSize;
+    
+    // Everything pushed after this point is kept contiguous, even if the arena grows
+    u8 *contiguousStart;
+    
+    u32 tempCount;
+    umm highWater; // Most bytes ever in use at once, across all chunks
+};
+
+// Saved arena position. Everything pushed between BeginTempMemory() and EndTempMemory()
+// is thrown away at the end, including any chunks the arena grew into.
+struct TempMemory {
+    Arena *arena;
+    ArenaChunk *chunk;
+    umm used;
+};
+
+// Fixed-size free-list allocator layered on top of an arena. Freed elements are
+// threaded through their own memory so they can be handed back out in O(1).
+struct PoolFreeNode {
+    PoolFreeNode *next;
+};
+
+struct Pool {
+    Arena *arena;
+    u32 elementSize;
+    PoolFreeNode *firstFree;
+    
+    u32 liveCount;
+    u32 freeCount;
+    u32 highWaterCount;
 };
 
 struct Rectangle {
@@ -65,12 +136,36 @@ enum RenderEntryType {
     
     RenderEntryType_Text,
     
+    RenderEntryType_CachedVerts, // See VertexCache
+    
     RenderEntryType_Null,
 };
 
+struct VertexSpan {
+    u32 offset; // Bytes into VertexCache::data
+    u32 size;
+    b32 valid;
+};
+
+// Layers draw in this order, whatever group their entries are in. Within a layer, entries draw in the
+// order they were pushed, so script z and depth within a script come from the order things get drawn in.
+enum RenderLayer {
+    RenderLayer_Blocks,
+    RenderLayer_UI,
+    RenderLayer_Drag,
+    RenderLayer_Debug,
+    
+    RenderLayerCount,
+};
+
+// A RenderEntry's sortKey is its layer above its push index within the group
+#define RENDER_LAYER_SHIFT 24
+#define RENDER_ENTRY_INDEX_MASK ((1u << RENDER_LAYER_SHIFT) - 1)
+
 struct RenderEntry {
     RenderEntryType type;
-    Block* block;
+    u32 sortKey;
+    BlockHandle block;
     v2 P;
     v4 color;
     v4 outline;
@@ -80,6 +175,7 @@ struct RenderEntry {
             u32 hStretch;
             u32 vStretch;
         };
+        VertexSpan span; // RenderEntryType_CachedVerts
     };
     Rectangle rect;
     
@@ -103,10 +199,10 @@ enum InteractionType {
 
 struct Interaction {
     InteractionType type;
-    Block *block;
+    BlockHandle block;
     v2 blockP;
-    Script *script;
-    RenderEntry *entry;
+    ScriptHandle script;
+    RenderEntry *entry; // Lives in scratch, so it's only good during the frame it was set
     
     v2 mouseStartP;
     v2 mouseOffset;
@@ -118,25 +214,134 @@ enum BlockInputType {
     BlockInputType_Text,
 };
 
-struct Block {
-    Block *prev;
-    Block *next;
-    BlockType type;
+// Strings are interned, so two inputs with the same text share a single refcounted copy
+// and can be compared by pointer. The text is stored inline after the header.
+struct InternedString {
+    InternedString *nextInBucket;
+    u32 hash;
+    u32 length;
+    u32 refCount;
+    u32 sizeClass;
+    char text[1]; // Actually (length + 1) bytes
+};
+
+#define STRING_SLOT_MIN_SIZE 32u
+#define STRING_SLOT_SIZE_CLASS_COUNT 8 // Slots from 32 to 4096 bytes, header included
+
+struct StringTable {
+    Arena *arena;
+    InternedString **buckets;
+    u32 bucketCount; // Always a power of two
+    u32 count;
     
-    BlockInputType inputType;
+    Pool slotPools[STRING_SLOT_SIZE_CLASS_COUNT];
+};
+
+// Blocks are stored as parallel arrays indexed by slot, split by how often they're touched.
+// Walking and laying out stacks only needs types and links. Inputs are only read when drawing them.
+struct BlockLinks {
+    BlockHandle prev;
+    BlockHandle next;
+    
+    // Loops
+    BlockHandle inner;
+    BlockHandle parent; // Points to the loop block that encloses this sub-stack
+};
+
+struct BlockInput {
+    BlockInputType type;
     union {
-        f32 inputNumber;
-        char *inputText;
+        f32 number;
+        InternedString *text;
     };
+};
+
+// What laying a block out last came to, so stacks that haven't changed don't have to be measured again.
+// Positions aren't kept, since they're just a running sum of the sizes that drawing does anyway.
+struct BlockLayout {
+    v2 size;      // The block itself, stretched around its inner stack
+    v2 stackSize; // From this block to the end of its chain of next links, inner stacks included
+    b32 dirty;    // Set on a changed block and everything it's attached under. See MarkBlockLayoutDirty().
+};
+
+struct BlockStore {
+    HandleTable handles;
     
-    // Loops
-    Block *inner;
-    Block *parent; // Points to the loop block that encloses this sub-stack
+    // Tightly packed. Deleting a block moves the last one into its slot.
+    BlockHandle *selfHandles; // Each slot's own handle, for fixing up the handle table when blocks move
+    u8 *types;                // BlockType
+    BlockLinks *links;
+    ScriptHandle *scripts;    // The script each block belongs to. Kept up to date by every link change.
+    BlockInput *inputs;
+    BlockLayout *layouts;
+    
+    u32 count;
+    u32 capacity;
+    u32 highWaterCount;
+    u32 editsSinceRelocation; // Bumped by anything that changes the shape of a stack. See RelocateBlocksInTraversalOrder().
+};
+
+// Relocating copies all of block storage, so RunBlocks() waits until a good share of it has been edited out
+// of order, and then until nothing has happened for a little while, so the copy doesn't land right on a drop
+#define RELOCATION_MIN_EDITS 256
+#define RELOCATION_EDIT_FRACTION 8 // Or one edit for every this many blocks, if that's more
+#define RELOCATION_IDLE_FRAMES 60
+
+struct GridCellRange {
+    s32 minX;
+    s32 minY;
+    s32 maxX;
+    s32 maxY;
 };
 
 struct Script {
+    ScriptHandle handle; // This script's own handle
     v2 P;
-    Block *topBlock;
+    BlockHandle topBlock;
+    BlockHandle lastBlock; // End of the chain of next links from topBlock (i.e., not counting inner stacks)
+    
+    // Where the script was the last time it was laid out, and the grid cells it's filed under for it
+    Rectangle bounds;
+    GridCellRange cells;
+    b32 inGrid;
+    b32 boundsDirty; // Moved or changed shape since bounds were taken, so it gets measured again before the grid is used
+    
+    u32 drawFrame; // Set to the current frameIndex once the script is picked to be drawn
+    u32 pickFrame; // Set to the current frameIndex when the mouse is over the script's bounds
+    u32 snapDrag; // Set to the current SnapIndex::dragIndex once this script's connectors are in the index
+    
+    VertexSpan cachedVerts; // Its blocks and their text, all from blocksRenderGroup. Dropped by MarkScriptDirty()
+};
+
+// Uniform grid over the workspace that files each script under every cell its bounds touch, so culling and
+// picking only have to look at the scripts near a rectangle or a point. The workspace is unbounded, so cells
+// are hashed into buckets, and each bucket chains together the (cell, script) pairs in it.
+#define SCRIPT_GRID_CELL_SIZE 32.0f // Workspace units, about two command blocks across
+#define SNAP_MARGIN 16.0f // A script whose bounds are farther than this from the dragged script's can't have anything to snap to
+
+struct ScriptGridNode {
+    ScriptHandle script;
+    s32 cellX;
+    s32 cellY;
+    u32 nextInBucket; // 0 ends the chain. Free nodes are chained through this too.
+};
+
+// Slots of the scripts to draw this frame. Lives in scratch.
+struct ScriptDrawList {
+    u32 *slots;
+    u32 count;
+    u32 capacity;
+};
+
+struct ScriptGrid {
+    u32 *buckets; // Index of the first node in each bucket. Lives in permanent.
+    u32 bucketCount; // Always a power of two
+    
+    ScriptGridNode *nodes; // Lives in the workspace. Node 0 is never used, so an index of 0 means none.
+    u32 nodeCount;
+    u32 nodeCapacity;
+    u32 firstFreeNode;
+    u32 liveNodeCount;
 };
 
 enum InsertionType {
@@ -147,69 +352,352 @@ enum InsertionType {
 };
 
 struct DragInfo {
-    Script *script;
+    ScriptHandle script;
     Layout scriptLayout;
-    Block *firstBlock;
-    Block *lastBlock;
+    BlockHandle firstBlock;
+    BlockHandle lastBlock;
+    
+    // Refreshed every frame, so drawing the other scripts doesn't have to look up the dragged blocks
+    BlockType firstBlockType;
+    BlockType lastBlockType;
+    b32 firstBlockHasInner;
+    
     Rectangle inlet;
     Rectangle outlet;
     Rectangle innerOutlet;
     
     b32 readyToInsert;
     InsertionType insertionType;
-    Block *insertionBaseBlock;
-    Script *insertionBaseScript;
+    BlockHandle insertionBaseBlock;
+    ScriptHandle insertionBaseScript;
+};
+
+// Every connector the dragged blocks could attach to. The rest of the workspace holds still during a drag,
+// so a script's connectors get gathered the first time the dragged blocks come near it and kept until the
+// drag ends. Candidates are filed by the grid cells they touch, hashed the same way as ScriptGrid, so each
+// frame only has to look at the ones near the dragged blocks' own connectors.
+struct SnapCandidate {
+    InsertionType type;
+    BlockHandle block;
+    ScriptHandle script;
+    Rectangle rect; // Connector on the block we'd be attaching to, in workspace coordinates
 };
 
+struct SnapCellEntry {
+    u32 candidate;
+    s32 cellX;
+    s32 cellY;
+    u32 nextInBucket; // 0 ends the chain
+};
+
+struct SnapIndex {
+    // All of these live in the workspace, and are emptied out when the drag ends
+    SnapCandidate *candidates;
+    u32 candidateCount;
+    u32 candidateCapacity;
+    
+    SnapCellEntry *entries; // Entry 0 is never used. A candidate that spans several cells gets an entry for each.
+    u32 entryCount;
+    u32 entryCapacity;
+    
+    u32 *buckets; // Index of the first entry in each bucket
+    u32 bucketCount; // Always a power of two
+    u32 bucketCapacity;
+    
+    u32 dragIndex; // Bumped every drag. See Script::snapDrag.
+};
+
+// Vertices kept from earlier frames, for scripts that haven't changed since they were last drawn in full.
+// A script that's clean and all the way on screen copies its spans straight into the frame instead of being
+// drawn again. Spans are only ever appended; the ones that get dropped are left as garbage until
+// RepackVertexCache() copies the rest somewhere new.
+struct VertexCache {
+    u8 *data; // Lives in the workspace
+    u32 used;
+    u32 capacity;
+    u32 garbage; // Bytes no script's span points at anymore
+};
+
+// The index buffer BLOCKS_INDEXED_QUADS builds hand the host. It's the same run of quad indices every frame,
+// so it's kept across frames and only extended when a draw call has more quads than it covers.
+struct QuadIndexBuffer {
+    u8 *data; // Lives in the workspace
+    u32 quadCount;
+    u32 capacity; // In bytes
+    u32 indexSize;
+};
+
+#define VERTEX_CACHE_MIN_REPACK_SIZE (64 * 1024)
+#define VERTEX_CACHE_MAX_IDLE_FRAMES 600 // Scripts that haven't been drawn for this long lose their spans at the next repack
+
+// Block shapes and inputs are drawn from templates built once at init: instanced by the host in
+// BLOCKS_INSTANCED_BLOCKS builds, or by PushTemplateVerts() otherwise
+#define BLOCK_TEMPLATE_COUNT (RenderEntryType_InputText + 1)
+
+#ifdef BLOCKS_INSTANCED_BLOCKS
+// Text is instanced too, one instance per character, from a template for each FONT_DATA entry after the
+// block ones. That keeps text in the instance stream, in order with the blocks it's drawn on.
+#define GLYPH_TEMPLATE_COUNT 127
+#else
+#define GLYPH_TEMPLATE_COUNT 0
+#endif
+#define TEMPLATE_COUNT (BLOCK_TEMPLATE_COUNT + GLYPH_TEMPLATE_COUNT)
+
+struct BlockTemplates {
+    // TEMPLATE_COUNT runs of vertexStride. Lives in permanent.
+    // Plain triangle lists when instanced, otherwise laid out like PushVerts_() would push them.
+    BlocksTemplateVertex *vertices;
+    u32 vertexCounts[TEMPLATE_COUNT];
+    u32 vertexStride;
+};
+
+inline
+b32 HasBlockTemplate(RenderEntryType type) {
+    return type < BLOCK_TEMPLATE_COUNT;
+}
+
+#ifdef BLOCKS_INSTANCED_BLOCKS
+inline
+b32 IsInstancedEntryType(RenderEntryType type) {
+    return HasBlockTemplate(type) || type == RenderEntryType_Text;
+}
+#endif
+
 struct TransformPair {
     mat4x4 transform;
     mat4x4 invTransform;
 };
 
+// Render entries are pushed into the scratch arena a chunk at a time, so they cost nothing between frames
+// and a pointer to an entry stays good until the end of the frame
+struct RenderEntryChunk {
+    RenderEntryChunk *next;
+    RenderEntry *entries;
+    u32 count;
+    u32 capacity;
+};
+
+// A script's entries in a render group, whose vertices get kept in the VertexCache once they're assembled
+struct VertexCapture {
+    ScriptHandle script;
+    u32 firstKey;
+    u32 endKey; // The key the entry after the last one would get
+};
+
 struct RenderGroup {
-    RenderEntry entries[4096];
+    RenderEntryChunk *firstChunk;
+    RenderEntryChunk *lastChunk;
     u32 entryCount;
+    u32 reservedCount;
+    u32 highWaterCount;
     mat4x4 transform;
     mat4x4 invTransform;
     v2 mouseP; // Unprojected into the coordinate system of the render group
+    Rectangle cullBounds; // What the transform puts on screen (plus CULL_MARGIN), in the same coordinates. Blocks outside it don't push entries.
+    
+    RenderLayer layer; // What new entries get drawn as
+    
+    VertexCapture *captures; // In entry order. Lives in scratch, like the entries.
+    u32 captureCount;
+    u32 captureCapacity;
+    u32 nextCapture;
+    umm captureStart;
+    
+    // Set by SortRenderGroup(). Entries in sortKey order, and where each layer starts in them.
+    RenderEntry **sortedEntries;
+    u32 layerStarts[RenderLayerCount + 1];
+};
+
+// One group's entries in one layer, and the draw call they go in. Worked out before anything is
+// assembled, so the draw calls can be pushed ahead of the vertices.
+// A run of one layer of a sorted group, from firstEntry up to endEntry in its sortedEntries
+struct DrawSegment {
+    RenderGroup *group;
+    RenderLayer layer;
+    u32 firstEntry;
+    u32 endEntry;
+    u32 drawCallIndex;
 };
 
 struct BlocksContext {
     BlocksInput input;
     
+    BlocksAllocator allocator;
+    
     Arena permanent;
-    Arena frame;
+    Arena frame;   // Only holds the buffers handed back to the host, so they stay contiguous
+    Arena scratch; // Everything else that only needs to live until the end of the frame
+    Arena workspace; // Block and script storage. Only ever addressed through handles, so it can be compacted.
+    
+    BlockStore blockStore;
+    HandleTable scriptHandles;
+    StringTable strings;
     
     RenderGroup blocksRenderGroup;
     RenderGroup uiRenderGroup;
-    RenderGroup dragRenderGroup;
-    RenderGroup debugRenderGroup;
     
-    RenderGroup fontRenderGroup;
-    
-    Script scripts[1024];
+    Script *scripts; // Lives in the workspace, tightly packed. Deleting a script moves the last one into its slot.
     u32 scriptCount;
+    u32 scriptCapacity;
+    
+    ScriptGrid scriptGrid;
+    ScriptHandle *dirtyScripts; // Scripts with boundsDirty set, waiting to be laid out. Lives in the workspace.
+    u32 dirtyScriptCount;
+    u32 dirtyScriptCapacity;
+    
+    VertexCache vertexCache;
+    QuadIndexBuffer quadIndices;
+    BlockTemplates blockTemplates;
+    
+    u32 frameIndex;
+    u32 idleFrameCount; // Frames in a row with nothing being interacted with, pressed or scrolled
     
     Interaction hot;
     Interaction interacting;
     Interaction nextHot;
     
     DragInfo dragInfo;
+    SnapIndex snapIndex;
     
     v2 screenSize;
     f32 zoomLevel;
     v2 cameraOrigin;
+    
+    BlocksStats stats;
+    BlocksBudgetFunc budgetCallback;
+    f32 budgetFraction;
+    void *budgetUserData;
 };
 
 void BeginBlocks(BlocksInput input);
+void MarkScriptDirty(ScriptHandle handle);
+void ReleaseScriptVerts(Script *script);
+Rectangle ScriptLayoutBounds(Script *script);
 BlocksRenderInfo EndBlocks();
-void DrawSubScript(RenderGroup *renderGroup, Block *block, Script *script, Layout *layout);
-b32 DrawBlock(RenderGroup *renderGroup, Block *block, Script *script, Layout *layout);
-void DrawSimpleBlock(RenderGroup *renderGroup, BlockType blockType, Block *block, Script *script, Layout *layout, u32 flags = 0);
-void DrawBranchBlock(RenderGroup *renderGroup, BlockType blockType, Block *block, Script *script, Layout *layout, Layout *innerLayout, u32 flags = 0);
+void DrawSubScript(RenderGroup *renderGroup, BlockHandle block, Script *script, Layout *layout);
+b32 DrawBlock(RenderGroup *renderGroup, BlockHandle block, Script *script, Layout *layout);
+void DrawSimpleBlock(RenderGroup *renderGroup, BlockType blockType, BlockHandle block, Script *script, Layout *layout, u32 flags = 0);
+void DrawBranchBlock(RenderGroup *renderGroup, BlockType blockType, BlockHandle block, Script *script, Layout *layout, Layout *innerLayout, u32 flags = 0);
 void DrawGhostBlock(RenderGroup *renderGroup, BlockType blockType, Layout *layout, Layout *innerLayout = 0);
 
-void *PushSize(Arena *arena, u32 size) {
+#define ARENA_MIN_CHUNK_SIZE Kilobytes(64)
+
+void GrowArena(Arena *arena, umm minSize) {
+    if (!arena->allocator) {
+        return;
+    }
+    
+    // Carry the contiguous region (if any) over into the new chunk
+    umm keepSize = 0;
+    if (arena->contiguousStart) {
+        keepSize = (umm)(arena->data + arena->used - arena->contiguousStart);
+    }
+    
+    // Each chunk is at least double the last, so the arena's capacity grows geometrically and a
+    // contiguous region doesn't get copied over again on every push
+    umm chunkSize = keepSize + minSize;
+    if (chunkSize < arena->minChunkSize) {
+        chunkSize = arena->minChunkSize;
+    }
+    if (chunkSize < arena->size * 2) {
+        chunkSize = arena->size * 2;
+    }
+    
+    u8 *mem = (u8 *)arena->allocator->allocate(sizeof(ArenaChunk) + chunkSize);
+    Assert(mem);
+    
+    ArenaChunk *chunk = (ArenaChunk *)mem;
+    chunk->prevData = arena->data;
+    chunk->prevSize = arena->size;
+    chunk->prevUsed = arena->used - keepSize;
+    chunk->prevChunk = arena->chunk;
+    
+    arena->chunk = chunk;
+    arena->data = mem + sizeof(ArenaChunk);
+    arena->size = chunkSize;
+    arena->used = 0;
+    
+    if (keepSize) {
+        memcpy(arena->data, arena->contiguousStart, keepSize);
+        arena->contiguousStart = arena->data;
+        arena->used = keepSize;
+    }
+}
+
+// Bytes in use across all chunks
+umm ArenaTotalUsed(Arena *arena) {
+    umm result = arena->used;
+    for (ArenaChunk *chunk = arena->chunk; chunk; chunk = chunk->prevChunk) {
+        result += chunk->prevUsed;
+    }
+    return result;
+}
+
+// Bytes reserved across all chunks
+umm ArenaTotalSize(Arena *arena) {
+    umm result = arena->size;
+    for (ArenaChunk *chunk = arena->chunk; chunk; chunk = chunk->prevChunk) {
+        result += chunk->prevSize;
+    }
+    return result;
+}
+
+// Call before anything gets popped off the arena
+void UpdateArenaHighWater(Arena *arena) {
+    umm used = ArenaTotalUsed(arena);
+    if (used > arena->highWater) {
+        arena->highWater = used;
+    }
+}
+
+void FreeLastChunk(Arena *arena) {
+    ArenaChunk *chunk = arena->chunk;
+    Assert(chunk);
+    umm chunkSize = arena->size;
+    
+    arena->data = chunk->prevData;
+    arena->size = chunk->prevSize;
+    arena->used = chunk->prevUsed;
+    arena->chunk = chunk->prevChunk;
+    
+    arena->allocator->free(chunk, sizeof(ArenaChunk) + chunkSize);
+}
+
+// Gives every chunk back to the host and empties the arena, leaving only the memory it started with
+void FreeArenaChunks(Arena *arena) {
+    Assert(arena->tempCount == 0);
+    UpdateArenaHighWater(arena);
+    arena->contiguousStart = 0;
+    while (arena->chunk) {
+        FreeLastChunk(arena);
+    }
+    arena->used = 0;
+}
+
+// Empties the arena. If it grew into more than one chunk since it was last cleared, the chunks are
+// coalesced into a single one big enough for all of them, so steady-state frames don't hit the allocator.
+void ClearArena(Arena *arena) {
+    Assert(arena->tempCount == 0);
+    UpdateArenaHighWater(arena);
+    arena->contiguousStart = 0;
+    if (arena->chunk && arena->chunk->prevChunk) {
+        umm totalSize = 0;
+        while (arena->chunk) {
+            totalSize += arena->size;
+            FreeLastChunk(arena);
+        }
+        totalSize += arena->size;
+        arena->used = 0;
+        GrowArena(arena, totalSize);
+    }
+    arena->used = 0;
+}
+
+void *PushSize(Arena *arena, umm size) {
+  if (arena->used + size > arena->size) {
+      GrowArena(arena, size);
+  }
+  
   // Make sure we have enough space left in the arena
   Assert(arena->used + size <= arena->size);
   
@@ -219,16 +707,18 @@ void *PushSize(Arena *arena, u32 size) {
   return result;
 }
 
-void PushData_(Arena *arena, void *data, u32 size) {
+void PushData_(Arena *arena, void *data, umm size) {
     void *location = PushSize(arena, size);
     memcpy(location, data, size);
 }
 
-Arena SubArena(Arena *arena, u32 size) {
+Arena SubArena(Arena *arena, umm size) {
     Arena subArena = {};
     subArena.data = (u8 *)PushSize(arena, size);
     subArena.size = size;
     subArena.used = 0;
+    subArena.allocator = arena->allocator;
+    subArena.minChunkSize = arena->minChunkSize;
     return subArena;
 }
 
@@ -237,5 +727,208 @@ u8 *ArenaAt(Arena *arena) {
     return arena->data + arena->used;
 }
 
+// Pads the arena so the next push starts on a multiple of alignment (a power of two)
+inline
+void AlignArena(Arena *arena, umm alignment) {
+    umm misalignment = (umm)ArenaAt(arena) & (alignment - 1);
+    if (misalignment) {
+        umm alignedUsed = arena->used + (alignment - misalignment);
+        // If the padding doesn't fit, the next push will move on to a fresh (aligned) chunk anyway
+        arena->used = (alignedUsed < arena->size) ? alignedUsed : arena->size;
+    }
+}
+
+inline
+void BeginContiguousRegion(Arena *arena) {
+    Assert(!arena->contiguousStart);
+    arena->contiguousStart = ArenaAt(arena);
+}
+
+inline
+umm ContiguousRegionSize(Arena *arena) {
+    Assert(arena->contiguousStart);
+    return (umm)(ArenaAt(arena) - arena->contiguousStart);
+}
+
+// Returns the start of the region, which may have moved since BeginContiguousRegion()
+inline
+u8 *EndContiguousRegion(Arena *arena) {
+    u8 *result = arena->contiguousStart;
+    arena->contiguousStart = 0;
+    return result;
+}
+
+TempMemory BeginTempMemory(Arena *arena) {
+    TempMemory result;
+    result.arena = arena;
+    result.chunk = arena->chunk;
+    result.used = arena->used;
+    arena->tempCount++;
+    return result;
+}
+
+void EndTempMemory(TempMemory temp) {
+    Arena *arena = temp.arena;
+    UpdateArenaHighWater(arena);
+    while (arena->chunk != temp.chunk) {
+        FreeLastChunk(arena);
+    }
+    Assert(arena->used >= temp.used);
+    arena->used = temp.used;
+    
+    Assert(arena->tempCount > 0);
+    arena->tempCount--;
+}
+
 #define PushStruct(arena, type) (type *)PushSize(arena, sizeof(type))
 #define PushArray(arena, type, count) (type *)PushSize(arena, sizeof(type) * count)
+
+void InitPool(Pool *pool, Arena *arena, u32 elementSize) {
+    // Free elements store the free list link in place, so they must be at least that big
+    Assert(elementSize >= sizeof(PoolFreeNode));
+    *pool = {};
+    pool->arena = arena;
+    pool->elementSize = elementSize;
+}
+
+void *PoolAlloc(Pool *pool) {
+    void *result = 0;
+    if (pool->firstFree) {
+        PoolFreeNode *node = pool->firstFree;
+        pool->firstFree = node->next;
+        pool->freeCount--;
+        result = node;
+    }
+    else {
+        result = PushSize(pool->arena, pool->elementSize);
+    }
+    
+    pool->liveCount++;
+    if (pool->liveCount > pool->highWaterCount) {
+        pool->highWaterCount = pool->liveCount;
+    }
+    
+    return result;
+}
+
+void PoolFree(Pool *pool, void *element) {
+    Assert(element);
+    Assert(pool->liveCount > 0);
+    PoolFreeNode *node = (PoolFreeNode *)element;
+    node->next = pool->firstFree;
+    pool->firstFree = node;
+    pool->liveCount--;
+    pool->freeCount++;
+}
+
+// Makes room for at least minCapacity elements in an array that lives in arena, doubling as needed.
+// Outgrown arrays are left behind in the arena.
+void *ReserveArray_(Arena *arena, void *data, umm elementSize, u32 count, u32 *capacity, u32 minCapacity) {
+    static const u32 MIN_ARRAY_CAPACITY = 16;
+    if (minCapacity <= *capacity) {
+        return data;
+    }
+    
+    u32 newCapacity = (*capacity) ? (*capacity * 2) : MIN_ARRAY_CAPACITY;
+    while (newCapacity < minCapacity) {
+        newCapacity *= 2;
+    }
+    
+    void *newData = PushSize(arena, elementSize * newCapacity);
+    if (count) {
+        memcpy(newData, data, elementSize * count);
+    }
+    *capacity = newCapacity;
+    return newData;
+}
+
+#define ReserveArray(arena, type, array, count, capacity, minCapacity) ((array) = (type *)ReserveArray_((arena), (array), sizeof(type), (count), &(capacity), (minCapacity)))
+
+// Sorts values in place, a byte at a time, least significant byte first.
+// The buffer it ping-pongs through comes out of tempArena and is given back before it returns.
+// Bits below firstShift are left alone, so they have to be in order already wherever the bits above them match.
+void RadixSort(u32 *values, u32 count, Arena *tempArena, u32 firstShift = 0) {
+    if (count < 2) {
+        return;
+    }
+    
+    TempMemory temp = BeginTempMemory(tempArena);
+    u32 *source = values;
+    u32 *dest = (u32 *)PushSize(tempArena, sizeof(u32) * count);
+    for (u32 shift = firstShift; shift < 32; shift += 8) {
+        u32 offsets[256] = {};
+        for (u32 i = 0; i < count; ++i) {
+            offsets[(source[i] >> shift) & 0xFF]++;
+        }
+        if (offsets[(source[0] >> shift) & 0xFF] == count) {
+            // Every value has the same byte here, so this pass wouldn't move anything
+            continue;
+        }
+        
+        u32 total = 0;
+        for (u32 digit = 0; digit < 256; ++digit) {
+            u32 digitCount = offsets[digit];
+            offsets[digit] = total;
+            total += digitCount;
+        }
+        for (u32 i = 0; i < count; ++i) {
+            dest[offsets[(source[i] >> shift) & 0xFF]++] = source[i];
+        }
+        
+        u32 *swap = source;
+        source = dest;
+        dest = swap;
+    }
+    if (source != values) {
+        memcpy(values, source, sizeof(u32) * count);
+    }
+    EndTempMemory(temp);
+}
+
+// Returns the index of a new entry pointing at slot
+u32 AllocHandleEntry(HandleTable *table, Arena *arena, u32 slot) {
+    u32 index = 0;
+    if (table->firstFree) {
+        index = table->firstFree;
+        table->firstFree = table->entries[index].slot;
+        table->freeCount--;
+    }
+    else {
+        if (table->count == 0) {
+            // Reserve entry 0 for null handles
+            ReserveArray(arena, HandleEntry, table->entries, 0, table->capacity, 1);
+            table->entries[0] = {};
+            table->count = 1;
+        }
+        ReserveArray(arena, HandleEntry, table->entries, table->count, table->capacity, table->count + 1);
+        index = table->count++;
+        table->entries[index].generation = 1;
+    }
+    table->entries[index].slot = slot;
+    return index;
+}
+
+void FreeHandleEntry(HandleTable *table, u32 index) {
+    HandleEntry *entry = &table->entries[index];
+    // Bumping the generation invalidates any handles still pointing at this entry
+    entry->generation++;
+    if (entry->generation == 0) {
+        entry->generation = 1;
+    }
+    entry->slot = table->firstFree;
+    table->firstFree = index;
+    table->freeCount++;
+}
+
+inline
+b32 HandleIsLive(HandleTable *table, u32 index, u32 generation) {
+    return index && index < table->count && table->entries[index].generation == generation;
+}
+
+inline b32 operator==(BlockHandle a, BlockHandle b) { return a.index == b.index && a.generation == b.generation; }
+inline b32 operator!=(BlockHandle a, BlockHandle b) { return !(a == b); }
+inline b32 operator==(ScriptHandle a, ScriptHandle b) { return a.index == b.index && a.generation == b.generation; }
+inline b32 operator!=(ScriptHandle a, ScriptHandle b) { return !(a == b); }
+
+#define InitPoolForType(pool, arena, type) InitPool(pool, arena, sizeof(type))
+#define PoolAllocStruct(pool, type) (type *)PoolAlloc(pool)
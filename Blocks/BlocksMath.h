@@ -30,6 +30,20 @@ b32 RectsIntersect(Rectangle a, Rectangle b) {
       && (b.y < (a.y + a.h));
 }
 
+inline
+b32 RectContainsRect(Rectangle outer, Rectangle inner) {
+    return (inner.x >= outer.x && inner.x + inner.w <= outer.x + outer.w)
+        && (inner.y >= outer.y && inner.y + inner.h <= outer.y + outer.h);
+}
+
+inline
+Rectangle InflateRectangle(Rectangle rect, f32 margin) {
+    return Rectangle{ rect.x - margin,
+                      rect.y - margin,
+                      rect.w + (2.0f * margin),
+                      rect.h + (2.0f * margin)};
+}
+
 inline
 Rectangle TranslateRectangle(Rectangle rect, v2 translation) {
     return Rectangle{ rect.origin.x + translation.x,
@@ -18,6 +18,7 @@ const char *BlocksShaders_Metal = R"END(
 
 using namespace metal;
 
+// The host's vertex descriptor widens packed BlocksVertex fields, so these stay float either way
 struct VertexIn {
     float2 position [[ attribute(0) ]];  
     float2 texCoord [[ attribute(1) ]];
@@ -38,9 +39,9 @@ struct WorldUniforms {
 };
 
 vertex VertexOut TexturedVertex(VertexIn in [[ stage_in ]],
-                                const device WorldUniforms *worldUniforms [[ buffer(1) ]],
+                                constant WorldUniforms &worldUniforms [[ buffer(1) ]],
                                 unsigned int vid [[ vertex_id ]]) {
-    float4x4 transform = worldUniforms[0].transform;
+    float4x4 transform = worldUniforms.transform;
     
     VertexOut out;
     out.texCoord = in.texCoord;
@@ -50,6 +51,65 @@ vertex VertexOut TexturedVertex(VertexIn in [[ stage_in ]],
     return out;
 }
 
+// These mirror BlocksTemplateVertex and BlocksInstance. The host defines BLOCKS_COMPACT_VERTICES
+// when it compiles this if IMBlocks was built with it.
+#ifdef BLOCKS_COMPACT_VERTICES
+struct BlockTemplateVertex {
+    packed_float2 offset;
+    packed_float2 stretch;
+    packed_ushort2 uv;
+};
+
+struct BlockInstance {
+    packed_float2 P;
+    packed_float2 stretch;
+    float scale;
+    uint templateIndex;
+    uchar4 color;
+    uchar4 outline;
+};
+#else
+struct BlockTemplateVertex {
+    packed_float2 offset;
+    packed_float2 stretch;
+    packed_float2 uv;
+};
+
+struct BlockInstance {
+    packed_float2 P;
+    packed_float2 stretch;
+    float scale;
+    uint templateIndex;
+    packed_float4 color;
+    packed_float4 outline;
+};
+#endif
+
+// Draw with templateVertexStride vertices per instance. ExpandBlocksInstances() is the CPU version of this.
+vertex VertexOut InstancedBlockVertex(constant WorldUniforms &worldUniforms [[ buffer(1) ]],
+                                      const device BlockTemplateVertex *templates [[ buffer(2) ]],
+                                      const device BlockInstance *instances [[ buffer(3) ]],
+                                      constant uint &templateVertexStride [[ buffer(4) ]],
+                                      unsigned int vid [[ vertex_id ]],
+                                      unsigned int iid [[ instance_id ]]) {
+    BlockInstance instance = instances[iid];
+    BlockTemplateVertex templateVert = templates[(instance.templateIndex * templateVertexStride) + vid];
+    float2 position = ((float2(templateVert.offset) * instance.scale) + float2(instance.P)) + (float2(templateVert.stretch) * float2(instance.stretch));
+    
+    VertexOut out;
+    out.position = worldUniforms.transform * float4(position.x, position.y, 0, 1.0);
+#ifdef BLOCKS_COMPACT_VERTICES
+    out.texCoord = float2(ushort2(templateVert.uv)) / 65535.0;
+    out.color = float4(instance.color) / 255.0;
+    out.outline = float4(instance.outline) / 255.0;
+#else
+    out.texCoord = float2(templateVert.uv);
+    out.color = float4(instance.color);
+    out.outline = float4(instance.outline);
+#endif
+    return out;
+}
+
 fragment float4 SdfFragment(VertexOut v [[ stage_in ]],
                             sampler samplr [[sampler(0)]],
                             texture2d<float, access::sample> blockTex [[ texture(0) ]]) {
@@ -32,11 +32,25 @@ typedef double   f64;
 typedef uint32_t b32;
 typedef uint64_t b64;
 
+// Memory sizes and offsets. These are 64-bit on 64-bit hosts so a single instance can grow
+// past 4GB. 32-bit targets (e.g., wasm32), or builds that define BLOCKS_32BIT_MEMORY, keep them compact.
+#if !defined(BLOCKS_32BIT_MEMORY) && UINTPTR_MAX == UINT32_MAX
+#define BLOCKS_32BIT_MEMORY
+#endif
+
+#ifdef BLOCKS_32BIT_MEMORY
+typedef uint32_t umm;
+#else
+typedef uint64_t umm;
+#endif
+
 #define Kilobytes(num) (num * 1024LL)
 #define Megabytes(num) (num * 1024LL * 1024LL)
 #define Gigabytes(num) (num * 1024LL * 1024LL * 1024LL)
 
 #define ArrayCount(array) (sizeof(array) / sizeof(array[0]))
+#define OffsetOf(type, member) ((umm)&(((type *)0)->member))
+#define AlignDown(value, alignment) ((value) & ~((umm)(alignment) - 1))
 
 #define Assert(expr) if(!(expr)) { *(volatile u32 *)0 = 0; }
 
@@ -10,8 +10,21 @@
 
 #include "font-atlas-small.h"
 
-#define PushVerts(arena, v) PushData_(arena, (v), sizeof((v)))
-#define VERTEX_SIZE (12 * sizeof(f32))
+// The vertex tables below are written out as floats (position, UV, color, outline) regardless
+// of the layout we actually hand to the host
+#define FLOATS_PER_VERTEX 12
+#define PushVerts(arena, v) PushVerts_(arena, (v), ArrayCount(v) / FLOATS_PER_VERTEX)
+#define VERTEX_SIZE sizeof(BlocksVertex)
+
+// The block tables are written against the block atlas on its own, which only takes up the left part
+// of the shared atlas (see BLOCKS_ATLAS_WIDTH)
+#define BLOCK_ATLAS_U_SCALE ((f32)BLOCKS_ATLAS_FONT_X / (f32)BLOCKS_ATLAS_WIDTH)
+
+#ifdef BLOCKS_INDEXED_QUADS
+#define QUAD_INDEX_SIZE(vertexCount) (((vertexCount) / 4) * 6 * sizeof(u16))
+#else
+#define QUAD_INDEX_SIZE(vertexCount) 0
+#endif
 
 #define COLOR_RED     v4{1, 0, 0, 1}
 #define COLOR_GREEN   v4{0, 1, 0, 1}
@@ -152,6 +165,91 @@ global_var BlockMetrics METRICS[BlockTypeCount] = {
     },
 };
 
+#ifdef BLOCKS_COMPACT_VERTICES
+inline
+u16 PackUnorm16(f32 value) {
+    return (u16)(Clamp(value, 0, 1) * 65535.0f + 0.5f);
+}
+
+inline
+u8 PackUnorm8(f32 value) {
+    return (u8)(Clamp(value, 0, 1) * 255.0f + 0.5f);
+}
+
+inline
+void PackRGBA8(u8 *out, v4 color) {
+    out[0] = PackUnorm8(color.r);
+    out[1] = PackUnorm8(color.g);
+    out[2] = PackUnorm8(color.b);
+    out[3] = PackUnorm8(color.a);
+}
+#endif
+
+// Appends vertices straight from a float table, packing them on the way if need be
+void PushTableVerts(Arena *arena, f32 *verts, u32 vertexCount) {
+#ifdef BLOCKS_COMPACT_VERTICES
+    BlocksVertex *out = (BlocksVertex *)PushSize(arena, vertexCount * sizeof(BlocksVertex));
+    for (u32 i = 0; i < vertexCount; ++i) {
+        f32 *in = verts + (i * FLOATS_PER_VERTEX);
+        out[i].P = v2{in[0], in[1]};
+        out[i].uv[0] = PackUnorm16(in[2]);
+        out[i].uv[1] = PackUnorm16(in[3]);
+        for (u32 c = 0; c < 4; ++c) {
+            out[i].color[c] = PackUnorm8(in[4 + c]);
+            out[i].outline[c] = PackUnorm8(in[8 + c]);
+        }
+    }
+#else
+    Assert(sizeof(BlocksVertex) == FLOATS_PER_VERTEX * sizeof(f32));
+    PushData_(arena, verts, vertexCount * sizeof(BlocksVertex));
+#endif
+}
+
+void PushVerts_(Arena *arena, f32 *verts, u32 vertexCount) {
+#ifdef BLOCKS_INDEXED_QUADS
+    // Every table is a list of quads, each one two triangles laid out (a, b, c), (b, c, d). Only a, b, c
+    // and d are kept; AssembleQuadIndexBuffer() stitches the triangles back together.
+    Assert(vertexCount % 6 == 0);
+    for (u32 first = 0; first < vertexCount; first += 6) {
+        f32 *quad = verts + (first * FLOATS_PER_VERTEX);
+        PushTableVerts(arena, quad, 3);
+        PushTableVerts(arena, quad + (5 * FLOATS_PER_VERTEX), 1);
+    }
+#else
+    PushTableVerts(arena, verts, vertexCount);
+#endif
+}
+
+// Places a block template the same way InstancedBlockVertex does: (offset * scale + P) + (stretch * stretch).
+// Everything but P and uv comes from fill.
+void InstantiateBlockTemplate(BlocksVertex *out, const BlocksTemplateVertex *templateVerts, u32 vertexCount,
+                              v2 P, v2 stretch, f32 scale, BlocksVertex fill) {
+    for (u32 i = 0; i < vertexCount; ++i) {
+        const BlocksTemplateVertex *templateVert = &templateVerts[i];
+        out[i] = fill;
+        out[i].P.x = ((templateVert->offset.x * scale) + P.x) + (templateVert->stretch.x * stretch.x);
+        out[i].P.y = ((templateVert->offset.y * scale) + P.y) + (templateVert->stretch.y * stretch.y);
+        memcpy(&out[i].uv, &templateVert->uv, sizeof(out[i].uv));
+    }
+}
+
+// Pushes what the block's vertex table would have, without building the table
+void PushTemplateVerts(Arena *arena, BlockTemplates *templates, u32 templateIndex,
+                       v2 P, v2 stretch, f32 scale, v4 color, v4 outline) {
+    BlocksVertex fill = {};
+#ifdef BLOCKS_COMPACT_VERTICES
+    PackRGBA8(fill.color, color);
+    PackRGBA8(fill.outline, outline);
+#else
+    fill.color = color;
+    fill.outline = outline;
+#endif
+    u32 vertexCount = templates->vertexCounts[templateIndex];
+    BlocksVertex *out = (BlocksVertex *)PushSize(arena, vertexCount * sizeof(BlocksVertex));
+    InstantiateBlockTemplate(out, templates->vertices + (templateIndex * templates->vertexStride), vertexCount,
+                             P, stretch, scale, fill);
+}
+
 void PushRect(Arena *arena, Rectangle rect, v2 uv0, v2 uv1, v4 color, v4 outline) {
     
     f32 verts[] = {
@@ -171,7 +269,7 @@ void PushRect(Arena *arena, Rectangle rect, v2 uv0, v2 uv1, v4 color, v4 outline
 
 void PushSolidRect(Arena *arena, Rectangle rect, v4 color) {
     // @TODO: @NOTE: The UV coords here are just a silly hack. They point at a texel firmly inside one of the block shapes (to force shader to definitely draw the fragments)
-    v2 uv = v2{75.0f / 255.0f, 75.0f / 255.0f};
+    v2 uv = v2{(75.0f / 255.0f) * BLOCK_ATLAS_U_SCALE, 75.0f / 255.0f};
     PushRect(arena, rect, uv, uv, color, color);
 }
 
@@ -180,70 +278,78 @@ void PushChar(Arena *arena, SdfFontChar character, f32 fontScale, v2 at, v4 colo
                                 at.y - (fontScale * (character.h + character.yOffset)), 
                                 (f32)character.w * fontScale, 
                                 (f32)character.h * fontScale };
-    v2 uv0 = v2{ (f32)character.x0 / 256.0f, (f32)character.y1 / 256.0f }; // Flip y
-    v2 uv1 = v2{ (f32)character.x1 / 256.0f, (f32)character.y0 / 256.0f };
+    v2 uv0 = v2{ (f32)(BLOCKS_ATLAS_FONT_X + character.x0) / BLOCKS_ATLAS_WIDTH, (f32)character.y1 / BLOCKS_ATLAS_HEIGHT }; // Flip y
+    v2 uv1 = v2{ (f32)(BLOCKS_ATLAS_FONT_X + character.x1) / BLOCKS_ATLAS_WIDTH, (f32)character.y0 / BLOCKS_ATLAS_HEIGHT };
     PushRect(arena, rect, uv0, uv1, color, outline);
 }
 
-// @TODO: Write our own strlen
+// Moves x from where str[i] starts to where the character after it does
+inline
+void AdvanceFontString(const char *str, u32 i, f32 fontScale, f32 *x) {
+    *x += FONT_DATA[str[i]].advance * fontScale;
+    if (str[i + 1]) {
+        f32 kern = KERN_TABLE[str[i + 1]][str[i]];
+        *x += kern * fontScale;
+    }
+}
+
 void PushFontString(Arena *arena, const char *str, v2 at, f32 fontHeight, v4 color, v4 outline) {
-    for (u32 i = 0; i < strlen(str); ++i) {
-        SdfFontChar c = FONT_DATA[str[i]];
-        f32 fontScale = ScaleForFontHeight(fontHeight);
-        PushChar(arena, c, fontScale, at, color, outline);
-        at.x += c.advance * fontScale;
-        if (i < strlen(str) - 1) {
-            f32 kern = KERN_TABLE[str[i + 1]][str[i]];
-            at.x += kern * fontScale;
-        }
+    f32 fontScale = ScaleForFontHeight(fontHeight);
+    for (u32 i = 0; str[i]; ++i) {
+        PushChar(arena, FONT_DATA[str[i]], fontScale, at, color, outline);
+        AdvanceFontString(str, i, fontScale, &at.x);
     }
 }
 
 void PushRectOutline(Arena *arena, Rectangle rect, v4 color, v4 outline) {
     #define rectWidth 0.5f
     #define rectHalfWidth (rectWidth / 2.0f)
+    #define solidU ((75.0f / 512.0f) * BLOCK_ATLAS_U_SCALE)
+    #define solidV (75.0f / 512.0f)
     
     // @TODO: @NOTE: The UV coords here are just a silly hack. They point at a texel firmly inside one of the block shapes (to force shader to definitely draw the fragments)
     f32 verts[] = {
         // Bottom
-        rect.x - rectHalfWidth,          rect.y - rectHalfWidth,          75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x + rect.w + rectHalfWidth, rect.y - rectHalfWidth,          75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x - rectHalfWidth,          rect.y + rectHalfWidth,          75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x - rectHalfWidth,          rect.y - rectHalfWidth,          solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rect.w + rectHalfWidth, rect.y - rectHalfWidth,          solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x - rectHalfWidth,          rect.y + rectHalfWidth,          solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        rect.x + rect.w + rectHalfWidth, rect.y - rectHalfWidth,          75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x - rectHalfWidth,          rect.y + rectHalfWidth,          75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x + rect.w + rectHalfWidth, rect.y + rectHalfWidth,          75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rect.w + rectHalfWidth, rect.y - rectHalfWidth,          solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x - rectHalfWidth,          rect.y + rectHalfWidth,          solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rect.w + rectHalfWidth, rect.y + rectHalfWidth,          solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         // Top
-        rect.x - rectHalfWidth,          rect.y + rect.h - rectHalfWidth, 75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x + rect.w + rectHalfWidth, rect.y + rect.h - rectHalfWidth, 75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x - rectHalfWidth,          rect.y + rect.h + rectHalfWidth, 75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x - rectHalfWidth,          rect.y + rect.h - rectHalfWidth, solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rect.w + rectHalfWidth, rect.y + rect.h - rectHalfWidth, solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x - rectHalfWidth,          rect.y + rect.h + rectHalfWidth, solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        rect.x + rect.w + rectHalfWidth, rect.y + rect.h - rectHalfWidth, 75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x - rectHalfWidth,          rect.y + rect.h + rectHalfWidth, 75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x + rect.w + rectHalfWidth, rect.y + rect.h + rectHalfWidth, 75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rect.w + rectHalfWidth, rect.y + rect.h - rectHalfWidth, solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x - rectHalfWidth,          rect.y + rect.h + rectHalfWidth, solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rect.w + rectHalfWidth, rect.y + rect.h + rectHalfWidth, solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         // Left
-        rect.x - rectHalfWidth,          rect.y + rectHalfWidth,          75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x + rectHalfWidth,          rect.y + rectHalfWidth,          75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x - rectHalfWidth,          rect.y + rect.h - rectHalfWidth, 75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x - rectHalfWidth,          rect.y + rectHalfWidth,          solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rectHalfWidth,          rect.y + rectHalfWidth,          solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x - rectHalfWidth,          rect.y + rect.h - rectHalfWidth, solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        rect.x + rectHalfWidth,          rect.y + rectHalfWidth,          75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x - rectHalfWidth,          rect.y + rect.h - rectHalfWidth, 75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x + rectHalfWidth,          rect.y + rect.h - rectHalfWidth, 75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rectHalfWidth,          rect.y + rectHalfWidth,          solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x - rectHalfWidth,          rect.y + rect.h - rectHalfWidth, solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rectHalfWidth,          rect.y + rect.h - rectHalfWidth, solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         // Right
-        rect.x + rect.w - rectHalfWidth, rect.y + rectHalfWidth,          75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x + rect.w + rectHalfWidth, rect.y + rectHalfWidth,          75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x + rect.w - rectHalfWidth, rect.y + rect.h - rectHalfWidth, 75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rect.w - rectHalfWidth, rect.y + rectHalfWidth,          solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rect.w + rectHalfWidth, rect.y + rectHalfWidth,          solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rect.w - rectHalfWidth, rect.y + rect.h - rectHalfWidth, solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        rect.x + rect.w + rectHalfWidth, rect.y + rectHalfWidth,          75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x + rect.w - rectHalfWidth, rect.y + rect.h - rectHalfWidth, 75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        rect.x + rect.w + rectHalfWidth, rect.y + rect.h - rectHalfWidth, 75.0f / 512.0f, 75.0f / 512.0f, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rect.w + rectHalfWidth, rect.y + rectHalfWidth,          solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rect.w - rectHalfWidth, rect.y + rect.h - rectHalfWidth, solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        rect.x + rect.w + rectHalfWidth, rect.y + rect.h - rectHalfWidth, solidU, solidV, color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
     };
     
     PushVerts(arena, verts);
     
+    #undef solidV
+    #undef solidU
     #undef rectHalfWidth
     #undef rectWidth
 }
@@ -251,23 +357,25 @@ void PushRectOutline(Arena *arena, Rectangle rect, v4 color, v4 outline) {
 void PushCommandBlockVerts(Arena *arena, v2 position, v4 color, v4 outline, f32 scale = 1) {
     #define unitSize 4.0f
     #define texSize  512.0f
+    #define texWidth (texSize / BLOCK_ATLAS_U_SCALE)
     #define originX  32.0f
     #define originY  96.0f
     
     f32 verts[] = {
-        (-1 * scale) + position.x, (-1 * scale) + position.y, (((-1 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        (19 * scale) + position.x, (-1 * scale) + position.y, (((19 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        (-1 * scale) + position.x, (17 * scale) + position.y, (((-1 * unitSize) + originX) / (texSize)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        (-1 * scale) + position.x, (-1 * scale) + position.y, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        (19 * scale) + position.x, (-1 * scale) + position.y, (((19 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        (-1 * scale) + position.x, (17 * scale) + position.y, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        (19 * scale) + position.x, (-1 * scale) + position.y, (((19 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        (-1 * scale) + position.x, (17 * scale) + position.y, (((-1 * unitSize) + originX) / (texSize)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        (19 * scale) + position.x, (17 * scale) + position.y, (((19 * unitSize) + originX) / (texSize)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        (19 * scale) + position.x, (-1 * scale) + position.y, (((19 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        (-1 * scale) + position.x, (17 * scale) + position.y, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        (19 * scale) + position.x, (17 * scale) + position.y, (((19 * unitSize) + originX) / (texWidth)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
     };
     
     PushVerts(arena, verts);
     
     #undef unitSize
     #undef texSize
+    #undef texWidth
     #undef originX
     #undef originY
 }
@@ -275,23 +383,25 @@ void PushCommandBlockVerts(Arena *arena, v2 position, v4 color, v4 outline, f32
 void PushEndCapBlockVerts(Arena *arena, v2 position, v4 color, v4 outline) {
     #define unitSize 4.0f
     #define texSize  512.0f
+    #define texWidth (texSize / BLOCK_ATLAS_U_SCALE)
     #define originX  288.0f
     #define originY  96.0f
     
     f32 verts[] = {
-        -1 + position.x, -1 + position.y, (((-1 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        18 + position.x, -1 + position.y, (((18 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x, 17 + position.y, (((-1 * unitSize) + originX) / (texSize)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x, -1 + position.y, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        18 + position.x, -1 + position.y, (((18 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x, 17 + position.y, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        18 + position.x, -1 + position.y, (((18 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x, 17 + position.y, (((-1 * unitSize) + originX) / (texSize)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        18 + position.x, 17 + position.y, (((18 * unitSize) + originX) / (texSize)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        18 + position.x, -1 + position.y, (((18 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x, 17 + position.y, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        18 + position.x, 17 + position.y, (((18 * unitSize) + originX) / (texWidth)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
     };
     
     PushVerts(arena, verts);
     
     #undef unitSize
     #undef texSize
+    #undef texWidth
     #undef originX
     #undef originY
 }
@@ -299,23 +409,25 @@ void PushEndCapBlockVerts(Arena *arena, v2 position, v4 color, v4 outline) {
 void PushEventBlockVerts(Arena *arena, v2 position, v4 color, v4 outline) {
     #define unitSize 4.0f
     #define texSize  512.0f
+    #define texWidth (texSize / BLOCK_ATLAS_U_SCALE)
     #define originX  160.0f
     #define originY  96.0f
     
     f32 verts[] = {
-        -1 + position.x, -1 + position.y, (((-1 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        20 + position.x, -1 + position.y, (((20 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x, 17 + position.y, (((-1 * unitSize) + originX) / (texSize)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x, -1 + position.y, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        20 + position.x, -1 + position.y, (((20 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x, 17 + position.y, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        20 + position.x, -1 + position.y, (((20 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x, 17 + position.y, (((-1 * unitSize) + originX) / (texSize)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        20 + position.x, 17 + position.y, (((20 * unitSize) + originX) / (texSize)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        20 + position.x, -1 + position.y, (((20 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x, 17 + position.y, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        20 + position.x, 17 + position.y, (((20 * unitSize) + originX) / (texWidth)), ((originY - (17 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
     };
     
     PushVerts(arena, verts);
     
     #undef unitSize
     #undef texSize
+    #undef texWidth
     #undef originX
     #undef originY
 }
@@ -323,16 +435,18 @@ void PushEventBlockVerts(Arena *arena, v2 position, v4 color, v4 outline) {
 void PushNumberInputVerts(Arena *arena, v2 position, v4 color, v4 outline) {
     #define unitSize 4.0f
     #define texSize  512.0f
+    #define texWidth (texSize / BLOCK_ATLAS_U_SCALE)
     #define originX  416.0f
     #define originY  128.0f
     
     Rectangle inputRect = Rectangle{ position.x - 1, position.y - 1, 12 + 2, 8 + 2 };
-    v2 uv0 = v2{ (originX - (1 * unitSize)) / texSize, (originY + (1 * unitSize)) / texSize };
-    v2 uv1 = v2{ (originX + ((inputRect.w - 1) * unitSize)) / texSize, (originY - ((inputRect.h - 1) * unitSize)) / texSize };
+    v2 uv0 = v2{ (originX - (1 * unitSize)) / texWidth, (originY + (1 * unitSize)) / texSize };
+    v2 uv1 = v2{ (originX + ((inputRect.w - 1) * unitSize)) / texWidth, (originY - ((inputRect.h - 1) * unitSize)) / texSize };
     PushRect(arena, inputRect, uv0, uv1, color, outline);
     
     #undef unitSize
     #undef texSize
+    #undef texWidth
     #undef originX
     #undef originY
 }
@@ -340,16 +454,18 @@ void PushNumberInputVerts(Arena *arena, v2 position, v4 color, v4 outline) {
 void PushTextInputVerts(Arena *arena, v2 position, v4 color, v4 outline) {
     #define unitSize 4.0f
     #define texSize  512.0f
+    #define texWidth (texSize / BLOCK_ATLAS_U_SCALE)
     #define originX  416.0f
     #define originY  64.0f
     
     Rectangle inputRect = Rectangle{ position.x - 1, position.y - 1, 12 + 2, 8 + 2 };
-    v2 uv0 = v2{ (originX - (1 * unitSize)) / texSize, (originY + (1 * unitSize)) / texSize };
-    v2 uv1 = v2{ (originX + ((inputRect.w - 1) * unitSize)) / texSize, (originY - ((inputRect.h - 1) * unitSize)) / texSize };
+    v2 uv0 = v2{ (originX - (1 * unitSize)) / texWidth, (originY + (1 * unitSize)) / texSize };
+    v2 uv1 = v2{ (originX + ((inputRect.w - 1) * unitSize)) / texWidth, (originY - ((inputRect.h - 1) * unitSize)) / texSize };
     PushRect(arena, inputRect, uv0, uv1, color, outline);
     
     #undef unitSize
     #undef texSize
+    #undef texWidth
     #undef originX
     #undef originY
 }
@@ -357,78 +473,80 @@ void PushTextInputVerts(Arena *arena, v2 position, v4 color, v4 outline) {
 void PushLoopBlockVerts(Arena *arena, v2 position, v4 color, v4 outline, u32 horizontalStretch = 0, u32 verticalStretch = 0) {
     #define unitSize 4.0f
     #define texSize  512.0f
+    #define texWidth (texSize / BLOCK_ATLAS_U_SCALE)
     #define originX  32.0f
     #define originY  208.0f
     
     f32 verts[] = {
         /* Left side (with connectors) */
-        -1 + position.x,                     -1 + position.y,                   (((-1 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         9 + position.x,                     -1 + position.y,                   ((( 9 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x,                     13 + position.y,                   (((-1 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     -1 + position.y,                   (((-1 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         9 + position.x,                     -1 + position.y,                   ((( 9 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     13 + position.y,                   (((-1 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-         9 + position.x,                     -1 + position.y,                   ((( 9 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x,                     13 + position.y,                   (((-1 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         9 + position.x,                     13 + position.y,                   ((( 9 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         9 + position.x,                     -1 + position.y,                   ((( 9 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     13 + position.y,                   (((-1 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         9 + position.x,                     13 + position.y,                   ((( 9 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         /* Stretchable vertical on left side */
-        -1 + position.x,                     13 + position.y,                   (((-1 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         7 + position.x,                     13 + position.y,                   ((( 7 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x,                     15 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     13 + position.y,                   (((-1 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     13 + position.y,                   ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     15 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-         7 + position.x,                     13 + position.y,                   ((( 7 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x,                     15 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     13 + position.y,                   ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     15 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         /* Upper left corner */
-        -1 + position.x,                     15 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x,                     21 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     15 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     21 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x,                     21 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         7 + position.x,                     21 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     21 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     21 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         /* Stretchable horizontal on top */
-         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         7 + position.x,                     21 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     21 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         7 + position.x,                     21 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     21 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         /* Upper right corner */
-        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        39 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        39 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        39 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         /* Stretchable vertical on right side */
-        21 + position.x + horizontalStretch, 13 + position.y,                   (((21 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        39 + position.x + horizontalStretch, 13 + position.y,                   (((39 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 13 + position.y,                   (((21 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 13 + position.y,                   (((39 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        39 + position.x + horizontalStretch, 13 + position.y,                   (((39 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        39 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 13 + position.y,                   (((39 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         /* Right side (with connectors) */
-        21 + position.x + horizontalStretch, -1 + position.y,                   (((21 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        41 + position.x + horizontalStretch, -1 + position.y,                   (((41 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 13 + position.y,                   (((21 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, -1 + position.y,                   (((21 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        41 + position.x + horizontalStretch, -1 + position.y,                   (((41 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 13 + position.y,                   (((21 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        41 + position.x + horizontalStretch, -1 + position.y,                   (((41 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 13 + position.y,                   (((21 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        41 + position.x + horizontalStretch, 13 + position.y,                   (((41 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        41 + position.x + horizontalStretch, -1 + position.y,                   (((41 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 13 + position.y,                   (((21 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        41 + position.x + horizontalStretch, 13 + position.y,                   (((41 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
     };
     
     PushVerts(arena, verts);
     
     #undef unitSize
     #undef texSize
+    #undef texWidth
     #undef originX
     #undef originY
 }
@@ -436,78 +554,80 @@ void PushLoopBlockVerts(Arena *arena, v2 position, v4 color, v4 outline, u32 hor
 void PushForeverBlockVerts(Arena *arena, v2 position, v4 color, v4 outline, u32 horizontalStretch = 0, u32 verticalStretch = 0) {
     #define unitSize 4.0f
     #define texSize  512.0f
+    #define texWidth (texSize / BLOCK_ATLAS_U_SCALE)
     #define originX  232.0f
     #define originY  208.0f
     
     f32 verts[] = {
         /* Left side (with connectors) */
-        -1 + position.x,                     -1 + position.y,                   (((-1 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         9 + position.x,                     -1 + position.y,                   ((( 9 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x,                     13 + position.y,                   (((-1 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     -1 + position.y,                   (((-1 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         9 + position.x,                     -1 + position.y,                   ((( 9 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     13 + position.y,                   (((-1 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-         9 + position.x,                     -1 + position.y,                   ((( 9 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x,                     13 + position.y,                   (((-1 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         9 + position.x,                     13 + position.y,                   ((( 9 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         9 + position.x,                     -1 + position.y,                   ((( 9 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     13 + position.y,                   (((-1 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         9 + position.x,                     13 + position.y,                   ((( 9 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         /* Stretchable vertical on left side */
-        -1 + position.x,                     13 + position.y,                   (((-1 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         7 + position.x,                     13 + position.y,                   ((( 7 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x,                     15 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     13 + position.y,                   (((-1 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     13 + position.y,                   ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     15 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-         7 + position.x,                     13 + position.y,                   ((( 7 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x,                     15 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     13 + position.y,                   ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     15 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         /* Upper left corner */
-        -1 + position.x,                     15 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x,                     21 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     15 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     21 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        -1 + position.x,                     21 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         7 + position.x,                     21 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        -1 + position.x,                     21 + position.y + verticalStretch, (((-1 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     21 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         /* Stretchable horizontal on top */
-         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         7 + position.x,                     21 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     15 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     21 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-         7 + position.x,                     21 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+         7 + position.x,                     21 + position.y + verticalStretch, ((( 7 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         /* Upper right corner */
-        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        39 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        39 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        39 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texSize)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 21 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texWidth)), ((originY - (21 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         /* Stretchable vertical on right side */
-        21 + position.x + horizontalStretch, 13 + position.y,                   (((21 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        39 + position.x + horizontalStretch, 13 + position.y,                   (((39 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 13 + position.y,                   (((21 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 13 + position.y,                   (((39 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        39 + position.x + horizontalStretch, 13 + position.y,                   (((39 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        39 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texSize)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 13 + position.y,                   (((39 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((21 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 15 + position.y + verticalStretch, (((39 * unitSize) + originX) / (texWidth)), ((originY - (15 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
         /* Right side (with connectors) */
-        21 + position.x + horizontalStretch, -1 + position.y,                   (((21 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        39 + position.x + horizontalStretch, -1 + position.y,                   (((39 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 13 + position.y,                   (((21 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, -1 + position.y,                   (((21 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, -1 + position.y,                   (((39 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 13 + position.y,                   (((21 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
         
-        39 + position.x + horizontalStretch, -1 + position.y,                   (((39 * unitSize) + originX) / (texSize)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        21 + position.x + horizontalStretch, 13 + position.y,                   (((21 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
-        39 + position.x + horizontalStretch, 13 + position.y,                   (((39 * unitSize) + originX) / (texSize)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, -1 + position.y,                   (((39 * unitSize) + originX) / (texWidth)), ((originY - (-1 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        21 + position.x + horizontalStretch, 13 + position.y,                   (((21 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
+        39 + position.x + horizontalStretch, 13 + position.y,                   (((39 * unitSize) + originX) / (texWidth)), ((originY - (13 * unitSize)) / (texSize)), color.r, color.g, color.b, color.a, outline.r, outline.g, outline.b, outline.a,
     };
     
     PushVerts(arena, verts);
     
     #undef unitSize
     #undef texSize
+    #undef texWidth
     #undef originX
     #undef originY
 }
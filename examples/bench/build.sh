@@ -0,0 +1,11 @@
+# Build the benchmarks
+
+mkdir -p build
+c++ -O2 -std=c++11 stress.cpp -o build/stress
+c++ -O2 -std=c++11 traversal.cpp -o build/traversal
+c++ -O2 -std=c++11 idle_frame.cpp -o build/idle_frame
+c++ -O2 -std=c++11 -DBLOCKS_COMPACT_VERTICES -DBLOCKS_INDEXED_QUADS idle_frame.cpp -o build/idle_frame_compact_indexed
+c++ -O2 -std=c++11 vertex_throughput.cpp -o build/vertex_throughput
+c++ -O2 -std=c++11 -DBLOCKS_COMPACT_VERTICES vertex_throughput.cpp -o build/vertex_throughput_compact
+c++ -O2 -std=c++11 -DBLOCKS_INSTANCED_BLOCKS vertex_throughput.cpp -o build/vertex_throughput_instanced
+c++ -O2 -std=c++11 -DBLOCKS_INSTANCED_BLOCKS -DBLOCKS_COMPACT_VERTICES -DBLOCKS_INDEXED_QUADS vertex_throughput.cpp -o build/vertex_throughput_instanced_compact_indexed
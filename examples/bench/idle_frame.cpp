@@ -0,0 +1,119 @@
+/*********************************************************
+*
+* idle_frame.cpp
+* IMBlocks
+*
+* Times RunBlocks() on a zoomed out workspace of small scripts that are all on screen
+* while nothing happens, which is the case the per-script vertex cache is for. It also
+* times frames where every script's cached vertices are thrown out first, so each one
+* gets tessellated again like it would be without the cache. Build it with the vertex
+* layout flags to see how much of an idle frame is copying vertices.
+*
+**********************************************************/
+
+#include "../../Blocks/Blocks.cpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define FRAME_COUNT 101
+
+static f64 GetSeconds() {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (f64)time.tv_sec + (f64)time.tv_nsec * 1e-9;
+}
+
+static int CompareF64(const void *a, const void *b) {
+    f64 difference = *(const f64 *)a - *(const f64 *)b;
+    return (difference > 0) - (difference < 0);
+}
+
+static void *BenchAllocate(umm size) {
+    return malloc(size);
+}
+
+static void BenchFree(void *mem, umm size) {
+    free(mem);
+}
+
+// Returns the median milliseconds for a frame. With dropCache set, every script's cached vertices are
+// thrown out before each frame, which doesn't mark anything dirty, so only the tessellation gets done again.
+static f64 TimeFrames(BlocksContext *context, BlocksInput *input, b32 dropCache, BlocksRenderInfo *lastRenderInfo) {
+    f64 times[FRAME_COUNT];
+    for (u32 frame = 0; frame < FRAME_COUNT; ++frame) {
+        if (dropCache) {
+            BlocksContext *previousCtx = EnterContext(context);
+            for (u32 i = 0; i < blocksCtx->scriptCount; ++i) {
+                ReleaseScriptVerts(&blocksCtx->scripts[i]);
+            }
+            LeaveContext(previousCtx);
+        }
+        f64 start = GetSeconds();
+        *lastRenderInfo = RunBlocks(context, input);
+        times[frame] = (GetSeconds() - start) * 1000.0;
+    }
+    qsort(times, FRAME_COUNT, sizeof(f64), CompareF64);
+    return times[FRAME_COUNT / 2];
+}
+
+int main(int argc, char **argv) {
+    u32 scriptCount = argc > 1 ? atoi(argv[1]) : 5000;
+
+    umm memSize = Megabytes(256);
+    void *mem = calloc(1, memSize);
+    BlocksAllocator allocator = {BenchAllocate, BenchFree};
+    BlocksContext *context = InitBlocksWithAllocator(mem, memSize, allocator);
+    BlocksContext *previousCtx = EnterContext(context);
+
+    // Three blocks a script, in a grid that fits on screen at this zoom
+    blocksCtx->zoomLevel = 0.25f;
+    for (u32 i = 0; i < scriptCount; ++i) {
+        BlockHandle command = CreateBlock(BlockType_Command);
+        SetBlockInputNumber(command, (f32)i);
+        CreateScript(v2{(f32)(i % 70) * 73.0f - 2500.0f, (f32)(i / 70) * 52.0f - 1850.0f}, command);
+        BlockHandle loop = CreateBlock(BlockType_Loop);
+        Connect(command, loop);
+        BlockHandle inner = CreateBlock(BlockType_Command);
+        ConnectInner(loop, inner);
+        SetBlockInputText(inner, "hi");
+    }
+    LeaveContext(previousCtx);
+
+    BlocksInput input = {};
+    input.screenSize = v2{1280, 960};
+    input.mouseP = v2{2000, 2000}; // Off the window, so no script is under the mouse
+
+    // Get everything laid out and into the cache first
+    BlocksRenderInfo renderInfo = {};
+    for (u32 frame = 0; frame < 5; ++frame) {
+        renderInfo = RunBlocks(context, &input);
+    }
+
+    f64 idleTime = TimeFrames(context, &input, false, &renderInfo);
+    BlocksRenderInfo idleRenderInfo = renderInfo;
+    f64 uncachedTime = TimeFrames(context, &input, true, &renderInfo);
+
+    b32 passed = (idleRenderInfo.vertexDataSize == renderInfo.vertexDataSize) && (idleRenderInfo.indexDataSize == renderInfo.indexDataSize);
+
+#ifdef BLOCKS_COMPACT_VERTICES
+    const char *layout = "compact";
+#else
+    const char *layout = "float";
+#endif
+#ifdef BLOCKS_INDEXED_QUADS
+    const char *quads = "indexed";
+#else
+    const char *quads = "unindexed";
+#endif
+    printf("%u scripts, %s %s vertices: %.3f ms per idle frame, %.3f ms retessellating every script (%.1fx), %.1f MB of vertices and indices\n",
+           scriptCount, layout, quads, idleTime, uncachedTime, uncachedTime / idleTime,
+           (f64)(idleRenderInfo.vertexDataSize + idleRenderInfo.indexDataSize) / (1024.0 * 1024.0));
+    if (!passed) {
+        printf("FAILED cached and retessellated frames aren't the same size\n");
+    }
+
+    free(mem);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/*********************************************************
+*
+* stress.cpp
+* IMBlocks
+*
+* Runs IMBlocks from a reservation bigger than 4 GB, with more than 4 GB pushed ahead of
+* the blocks and the vertex output, to catch anything that still truncates sizes or
+* offsets to 32 bits. The memory is reserved without being committed, so only the pages
+* that actually get touched count against the machine's RAM.
+*
+**********************************************************/
+
+#include "../../Blocks/Blocks.cpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#ifdef BLOCKS_32BIT_MEMORY
+
+int main() {
+    printf("stress: nothing to do in a BLOCKS_32BIT_MEMORY build\n");
+    return 0;
+}
+
+#else
+
+static f64 GetSeconds() {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (f64)time.tv_sec + (f64)time.tv_nsec * 1e-9;
+}
+
+static b32 Check(b32 condition, const char *what) {
+    printf("%s %s\n", condition ? "  ok  " : "FAILED", what);
+    return condition;
+}
+
+int main(int argc, char **argv) {
+    u32 scriptCount = argc > 1 ? atoi(argv[1]) : 100;
+    u32 blocksPerScript = argc > 2 ? atoi(argv[2]) : 10;
+    u32 frameCount = argc > 3 ? atoi(argv[3]) : 300;
+
+    // InitBlocks gives the permanent arena a quarter of the long-lived memory, which puts the frame
+    // arena and the workspace after it well past the 4 GB mark
+    umm memSize = Gigabytes(24);
+    u8 *mem = (u8 *)mmap(0, memSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED) {
+        printf("stress: couldn't reserve %llu bytes\n", (unsigned long long)memSize);
+        return 1;
+    }
+
+    f64 startTime = GetSeconds();
+    BlocksContext *context = InitBlocks(mem, memSize);
+    BlocksContext *previousCtx = EnterContext(context);
+
+    // Skip past the first 4 GB of the workspace without touching it, so every array pushed after this
+    // has an offset into the arena that doesn't fit in 32 bits
+    PushSize(&blocksCtx->workspace, Gigabytes(4) + Megabytes(1));
+
+    BlockHandle firstBlock = {};
+    for (u32 scriptIndex = 0; scriptIndex < scriptCount; ++scriptIndex) {
+        v2 P = v2{(f32)(scriptIndex % 10) * 60.0f - 300.0f, (f32)(scriptIndex / 10) * 80.0f - 300.0f};
+        BlockHandle prev = CreateBlock(BlockType_Event);
+        CreateScript(P, prev);
+        if (!firstBlock.index) {
+            firstBlock = prev;
+        }
+        for (u32 i = 1; i < blocksPerScript; ++i) {
+            BlockHandle block = CreateBlock((i % 8 == 0) ? BlockType_Loop : BlockType_Command);
+            if (i % 4 == 0) {
+                SetBlockInputNumber(block, (f32)i);
+            }
+            Connect(prev, block);
+            prev = block;
+        }
+    }
+    f64 setupTime = GetSeconds() - startTime;
+    printf("%u blocks in %u scripts, set up in %.1f ms\n", scriptCount * blocksPerScript, scriptCount, setupTime * 1000.0);
+
+    b32 passed = true;
+    passed &= Check(blocksCtx->workspace.size > Gigabytes(4), "workspace arena is bigger than 4 GB");
+    passed &= Check(blocksCtx->workspace.used > Gigabytes(4), "workspace arena has more than 4 GB in use");
+    passed &= Check((umm)((u8 *)GetBlockLinks(firstBlock) - mem) > Gigabytes(4), "block storage is more than 4 GB past the start of memory");
+    LeaveContext(previousCtx);
+
+    f64 firstFrameTime = 0;
+    f64 totalFrameTime = 0;
+    f64 worstFrameTime = 0;
+    BlocksRenderInfo firstRenderInfo = {};
+    for (u32 frame = 0; frame < frameCount; ++frame) {
+        BlocksInput input = {};
+        f32 t = (f32)(frame % 120) / 120.0f;
+        input.mouseP = v2{100.0f + 400.0f * t, 300.0f - 200.0f * t};
+        input.mouseDown = (frame % 120) > 10 && (frame % 120) < 90;
+        input.screenSize = v2{1280, 800};
+
+        f64 frameStart = GetSeconds();
+        BlocksRenderInfo renderInfo = RunBlocks(context, &input);
+        f64 frameTime = GetSeconds() - frameStart;
+
+        if (frame == 0) {
+            firstFrameTime = frameTime;
+            firstRenderInfo = renderInfo;
+        }
+        else {
+            totalFrameTime += frameTime;
+            worstFrameTime = Max(worstFrameTime, frameTime);
+        }
+    }
+    u32 drawnVertexCount = (u32)(firstRenderInfo.vertexDataSize / VERTEX_SIZE);
+
+    passed &= Check(drawnVertexCount > 0, "something got drawn");
+    passed &= Check((umm)(firstRenderInfo.vertexData - mem) > Gigabytes(4), "vertex data is more than 4 GB past the start of memory");
+
+    printf("first frame %.2f ms (%u vertices), then %.3f ms average, %.3f ms worst over %u frames\n",
+           firstFrameTime * 1000.0, drawnVertexCount,
+           frameCount > 1 ? totalFrameTime * 1000.0 / (frameCount - 1) : 0.0, worstFrameTime * 1000.0, frameCount);
+
+    munmap(mem, memSize);
+    return passed ? 0 : 1;
+}
+
+#endif
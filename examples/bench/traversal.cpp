@@ -0,0 +1,210 @@
+/*********************************************************
+*
+* traversal.cpp
+* IMBlocks
+*
+* Times walking every script's blocks the way DrawSubScript() does, with block storage
+* in creation order and then again after RelocateBlocksInTraversalOrder(). Blocks are
+* created in a shuffled order and some are freed along the way, so the walk starts out
+* jumping all over the arrays like it would after a lot of editing.
+*
+* After relocating, it also copies the blocks into an array of structs laid out like
+* Block was before block storage was split into per-field arrays, and times the same
+* walk over that, so the two layouts can be compared on identical order and handles.
+*
+**********************************************************/
+
+#include "../../Blocks/Blocks.cpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define WALK_COUNT 21
+
+static f64 GetSeconds() {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (f64)time.tv_sec + (f64)time.tv_nsec * 1e-9;
+}
+
+// Small xorshift so runs are the same everywhere
+static u32 randomState = 1234;
+static u32 Random() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+static f32 WalkStack(BlockStore *store, BlockHandle handle) {
+    f32 width = 0;
+    while (handle.index) {
+        u32 slot = GetBlockSlot(handle);
+        BlockLinks *links = &store->links[slot];
+        width += METRICS[store->types[slot]].size.w;
+        if (links->inner.index) {
+            width += WalkStack(store, links->inner);
+        }
+        handle = links->next;
+    }
+    return width;
+}
+
+// One entry of block storage as it was before it was split into per-field arrays
+struct AoSBlock {
+    BlockHandle handle;
+    BlockHandle prev;
+    BlockHandle next;
+    BlockType type;
+    
+    BlockInputType inputType;
+    union {
+        f32 inputNumber;
+        InternedString *inputText;
+    };
+    
+    BlockHandle inner;
+    BlockHandle parent;
+};
+
+static f32 WalkAoSStack(AoSBlock *blocks, BlockHandle handle) {
+    f32 width = 0;
+    while (handle.index) {
+        AoSBlock *block = &blocks[GetBlockSlot(handle)];
+        width += METRICS[block->type].size.w;
+        if (block->inner.index) {
+            width += WalkAoSStack(blocks, block->inner);
+        }
+        handle = block->next;
+    }
+    return width;
+}
+
+static int CompareF64(const void *a, const void *b) {
+    f64 difference = *(const f64 *)a - *(const f64 *)b;
+    return (difference > 0) - (difference < 0);
+}
+
+// Walks every script once, through aosBlocks if it's set and block storage otherwise. Returns milliseconds.
+// The sum of widths goes in check so the walks can be compared.
+static f64 WalkAll(f32 *check, AoSBlock *aosBlocks = 0) {
+    f64 start = GetSeconds();
+    f32 total = 0;
+    for (u32 i = 0; i < blocksCtx->scriptCount; ++i) {
+        BlockHandle topBlock = blocksCtx->scripts[i].topBlock;
+        total += aosBlocks ? WalkAoSStack(aosBlocks, topBlock) : WalkStack(&blocksCtx->blockStore, topBlock);
+    }
+    *check = total;
+    return (GetSeconds() - start) * 1000.0;
+}
+
+static f64 Median(f64 *times) {
+    qsort(times, WALK_COUNT, sizeof(f64), CompareF64);
+    return times[WALK_COUNT / 2];
+}
+
+// Returns the median of WALK_COUNT walks
+static f64 TimeWalks(f32 *check) {
+    f64 times[WALK_COUNT];
+    for (u32 walk = 0; walk < WALK_COUNT; ++walk) {
+        times[walk] = WalkAll(check);
+    }
+    return Median(times);
+}
+
+int main(int argc, char **argv) {
+    u32 blockCount = argc > 1 ? atoi(argv[1]) : 200000;
+    u32 scriptCount = 1000;
+    u32 blocksPerScript = blockCount / scriptCount;
+
+    umm memSize = Megabytes(1024);
+    void *mem = malloc(memSize);
+    BlocksContext *context = InitBlocks(mem, memSize);
+    BlocksContext *previousCtx = EnterContext(context);
+
+    BlockHandle *handles = (BlockHandle *)malloc(sizeof(BlockHandle) * blockCount);
+    for (u32 i = 0; i < blockCount; ++i) {
+        handles[i] = CreateBlock((Random() % 8 == 0) ? BlockType_Loop : BlockType_Command);
+        if (i % 4 == 0) {
+            SetBlockInputNumber(handles[i], (f32)i);
+        }
+    }
+    for (u32 i = blockCount - 1; i > 0; --i) {
+        u32 j = Random() % (i + 1);
+        BlockHandle temp = handles[i];
+        handles[i] = handles[j];
+        handles[j] = temp;
+    }
+
+    for (u32 scriptIndex = 0; scriptIndex < scriptCount; ++scriptIndex) {
+        BlockHandle *stack = handles + scriptIndex * blocksPerScript;
+        CreateScript(v2{0, 0}, stack[0]);
+        for (u32 i = 1; i < blocksPerScript; ++i) {
+            BlockHandle prev = stack[i - 1];
+            if (GetBlockType(prev) == BlockType_Loop && !GetBlockLinks(prev)->inner.index && (Random() & 1)) {
+                ConnectInner(prev, stack[i]);
+            }
+            else {
+                Connect(prev, stack[i]);
+            }
+        }
+    }
+    // Freeing the leftovers moves blocks from the end of storage into the holes
+    for (u32 i = scriptCount * blocksPerScript; i < blockCount; ++i) {
+        FreeBlock(handles[i]);
+    }
+
+    f32 checkBefore;
+    f32 checkAfter;
+    f64 before = TimeWalks(&checkBefore);
+
+    f64 relocateStart = GetSeconds();
+    RelocateBlocksInTraversalOrder();
+    f64 relocateTime = (GetSeconds() - relocateStart) * 1000.0;
+
+    f64 after = TimeWalks(&checkAfter);
+
+    printf("%u blocks: %.3f ms per walk before, %.3f ms after (%.2fx), relocating took %.3f ms\n",
+           scriptCount * blocksPerScript, before, after, before / after, relocateTime);
+
+    BlockStore *store = &blocksCtx->blockStore;
+    AoSBlock *aosBlocks = (AoSBlock *)malloc(sizeof(AoSBlock) * store->count);
+    for (u32 slot = 0; slot < store->count; ++slot) {
+        AoSBlock *block = &aosBlocks[slot];
+        BlockLinks *links = &store->links[slot];
+        block->handle = store->selfHandles[slot];
+        block->prev = links->prev;
+        block->next = links->next;
+        block->type = (BlockType)store->types[slot];
+        block->inputType = store->inputs[slot].type;
+        block->inputText = store->inputs[slot].text; // Copies the whole union
+        block->inner = links->inner;
+        block->parent = links->parent;
+    }
+    // Alternate the two so neither gets a warmer cache than the other
+    f32 checkAoS;
+    f32 checkSoA;
+    f64 aosTimes[WALK_COUNT];
+    f64 soaTimes[WALK_COUNT];
+    for (u32 walk = 0; walk < WALK_COUNT; ++walk) {
+        aosTimes[walk] = WalkAll(&checkAoS, aosBlocks);
+        soaTimes[walk] = WalkAll(&checkSoA);
+    }
+    f64 aosTime = Median(aosTimes);
+    f64 soaTime = Median(soaTimes);
+
+    printf("%u blocks in traversal order: %.3f ms per walk as structs (%u bytes each), %.3f ms as arrays (%.2fx)\n",
+           store->count, aosTime, (u32)sizeof(AoSBlock), soaTime, aosTime / soaTime);
+
+    b32 passed = (checkBefore == checkAfter) && (checkAoS == checkAfter) && (checkSoA == checkAfter);
+    if (!passed) {
+        printf("FAILED walks don't all match\n");
+    }
+
+    LeaveContext(previousCtx);
+    free(aosBlocks);
+    free(handles);
+    free(mem);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+/*********************************************************
+*
+* vertex_throughput.cpp
+* IMBlocks
+*
+* Times turning block render entries into vertices, through the templates and
+* InstantiateBlockTemplate() like EndBlocks() does, and through the per-block vertex
+* tables the templates are built from. Build it with whatever vertex layout flags
+* you care about to compare them.
+*
+* In BLOCKS_INSTANCED_BLOCKS builds it times ExpandBlocksInstances(), which does what the
+* instanced vertex shader does, on the instances EndBlocks() would send for each entry,
+* text included. That gets checked against the vertex tables and PushFontString().
+*
+**********************************************************/
+
+#include "../../Blocks/Blocks.cpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define ENTRY_COUNT 2000
+
+typedef void (*PushVertsFunc)(Arena *vertexArena, RenderEntry *entry);
+
+static f64 GetSeconds() {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (f64)time.tv_sec + (f64)time.tv_nsec * 1e-9;
+}
+
+// Returns the best vertices per second out of a few runs of batchCount batches
+static f64 TimePushVerts(PushVertsFunc pushVerts, Arena *vertexArena, RenderEntry *entries, u32 batchCount) {
+    f64 bestVertsPerSecond = 0;
+    for (u32 run = 0; run < 5; ++run) {
+        u64 vertexCount = 0;
+        f64 start = GetSeconds();
+        for (u32 batch = 0; batch < batchCount; ++batch) {
+            vertexArena->used = 0;
+            for (u32 i = 0; i < ENTRY_COUNT; ++i) {
+                pushVerts(vertexArena, &entries[i]);
+            }
+            vertexCount += vertexArena->used / sizeof(BlocksVertex);
+        }
+        f64 vertsPerSecond = (f64)vertexCount / (GetSeconds() - start);
+        bestVertsPerSecond = Max(bestVertsPerSecond, vertsPerSecond);
+    }
+    return bestVertsPerSecond;
+}
+
+#ifdef BLOCKS_INSTANCED_BLOCKS
+static BlocksRenderInfo templateInfo;
+static Arena instanceArena;
+
+// Pushes the vertices the host would draw for the entry's instances
+static void PushInstanceVerts(Arena *vertexArena, RenderEntry *entry) {
+    RenderGroup group = {};
+    group.sortedEntries = &entry;
+    DrawSegment segment = {};
+    segment.group = &group;
+    segment.endEntry = 1;
+    instanceArena.used = 0;
+    AssembleInstanceBufferForRenderGroup(&instanceArena, &segment);
+    
+    BlocksDrawCall drawCall = {};
+    drawCall.instanceCount = instanceArena.used / sizeof(BlocksInstance);
+    templateInfo.instanceData = (BlocksInstance *)instanceArena.data;
+    // Every template is at most vertexStride vertices, so there's room for them all
+    BlocksVertex *out = (BlocksVertex *)ArenaAt(vertexArena);
+    Assert(vertexArena->used + (drawCall.instanceCount * templateInfo.templateVertexStride * sizeof(BlocksVertex)) <= vertexArena->size);
+    u32 vertexCount = ExpandBlocksInstances(&templateInfo, &drawCall, out);
+    vertexArena->used += vertexCount * sizeof(BlocksVertex);
+}
+
+// Pushes the entry's vertices without templates, as the triangle lists instances expand to
+static void PushReferenceVerts(Arena *vertexArena, RenderEntry *entry) {
+#ifdef BLOCKS_INDEXED_QUADS
+    BlocksVertex pushed[1024];
+    Arena quadArena = {};
+    quadArena.data = (u8 *)pushed;
+    quadArena.size = sizeof(pushed);
+    Arena *pushedArena = &quadArena;
+#else
+    Arena *pushedArena = vertexArena;
+#endif
+    if (entry->type == RenderEntryType_Text) {
+        PushFontString(pushedArena, entry->text, entry->P, entry->textHeight, entry->color, entry->outline);
+    }
+    else {
+        PushBlockTableVerts(pushedArena, entry);
+    }
+#ifdef BLOCKS_INDEXED_QUADS
+    u32 pushedCount = (u32)(quadArena.used / sizeof(BlocksVertex));
+    BlocksVertex *out = (BlocksVertex *)PushSize(vertexArena, (pushedCount / 4) * 6 * sizeof(BlocksVertex));
+    ExpandQuadVerts(out, pushed, pushedCount);
+#endif
+}
+#endif
+
+int main(int argc, char **argv) {
+    u32 batchCount = argc > 1 ? atoi(argv[1]) : 200;
+
+    umm memSize = Megabytes(64);
+    void *mem = malloc(memSize);
+    BlocksContext *context = InitBlocks(mem, memSize);
+    BlocksContext *previousCtx = EnterContext(context);
+
+#ifdef BLOCKS_INSTANCED_BLOCKS
+    // Text gets instanced as well, so it's in the mix, as every tail of a string with all the printable characters
+    u32 typeCount = BLOCK_TEMPLATE_COUNT + 1;
+    char printable[127 - ' ' + 1];
+    for (u32 c = ' '; c < 127; ++c) {
+        printable[c - ' '] = (char)c;
+    }
+    printable[127 - ' '] = 0;
+#else
+    u32 typeCount = BLOCK_TEMPLATE_COUNT;
+#endif
+    
+    // A mix of every block shape, stretched and scaled different amounts. Each shape goes through every stretch.
+    RenderEntry *entries = (RenderEntry *)calloc(ENTRY_COUNT, sizeof(RenderEntry));
+    for (u32 i = 0; i < ENTRY_COUNT; ++i) {
+        RenderEntry *entry = &entries[i];
+        u32 shapeIndex = i / typeCount;
+        entry->type = (RenderEntryType)(i % typeCount);
+        entry->P = v2{(f32)(i * 3 % 977) + 0.5f, (f32)(i * 7 % 613)};
+        entry->scale = 1.0f + (f32)(i % 3) * 0.25f;
+        entry->hStretch = shapeIndex % 40;
+        entry->vStretch = shapeIndex % 30;
+#ifdef BLOCKS_INSTANCED_BLOCKS
+        if (i % typeCount == BLOCK_TEMPLATE_COUNT) {
+            entry->type = RenderEntryType_Text;
+            entry->text = printable + (shapeIndex % (127 - ' '));
+            entry->textHeight = 10.0f + (f32)(shapeIndex % 7) * 1.5f;
+        }
+#endif
+        entry->color = v4{0.2f, 0.4f, 0.6f, 1.0f};
+        entry->outline = v4{0.1f, 0.2f, 0.3f, 1.0f};
+    }
+
+    Arena templateArena = {};
+    templateArena.size = Megabytes(16);
+    templateArena.data = (u8 *)malloc(templateArena.size);
+    Arena tableArena = {};
+    tableArena.size = Megabytes(16);
+    tableArena.data = (u8 *)malloc(tableArena.size);
+
+#ifdef BLOCKS_INSTANCED_BLOCKS
+    BlockTemplates *templates = &blocksCtx->blockTemplates;
+    templateInfo.templateVertices = templates->vertices;
+    templateInfo.templateVertexCounts = templates->vertexCounts;
+    templateInfo.templateVertexStride = templates->vertexStride;
+    templateInfo.templateCount = TEMPLATE_COUNT;
+    instanceArena.size = Megabytes(1);
+    instanceArena.data = (u8 *)malloc(instanceArena.size);
+    
+    const char *templatePath = "instances";
+    f64 templateRate = TimePushVerts(PushInstanceVerts, &templateArena, entries, batchCount);
+    f64 tableRate = TimePushVerts(PushReferenceVerts, &tableArena, entries, batchCount);
+#else
+    const char *templatePath = "templates";
+    f64 templateRate = TimePushVerts(PushEntryVerts, &templateArena, entries, batchCount);
+    f64 tableRate = TimePushVerts(PushBlockTableVerts, &tableArena, entries, batchCount);
+#endif
+
+    b32 passed = (templateArena.used == tableArena.used) && !memcmp(templateArena.data, tableArena.data, templateArena.used);
+
+#ifdef BLOCKS_COMPACT_VERTICES
+    const char *layout = "compact";
+#else
+    const char *layout = "float";
+#endif
+    printf("%s vertices (%u bytes): %s %.1f Mverts/s, tables %.1f Mverts/s, %llu verts per batch\n",
+           layout, (u32)sizeof(BlocksVertex), templatePath, templateRate / 1e6, tableRate / 1e6,
+           (unsigned long long)(templateArena.used / sizeof(BlocksVertex)));
+    if (!passed) {
+        printf("FAILED %s and tables don't produce the same vertices\n", templatePath);
+    }
+
+    LeaveContext(previousCtx);
+#ifdef BLOCKS_INSTANCED_BLOCKS
+    free(instanceArena.data);
+#endif
+    free(tableArena.data);
+    free(templateArena.data);
+    free(entries);
+    free(mem);
+    return passed ? 0 : 1;
+}
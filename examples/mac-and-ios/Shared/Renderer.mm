@@ -22,8 +22,8 @@ static const u32 MAX_BUFFERS_IN_FLIGHT = 3;
 static const u32 MAX_BLOCKS = 1024;
 
 typedef void *DylibHandle;
-typedef void(*InitBlocksSignature)(void *, u32);
-typedef BlocksRenderInfo (*RunBlocksSignature)(void *, BlocksInput *);
+typedef BlocksContext *(*InitBlocksSignature)(void *, umm, BlocksAllocator);
+typedef BlocksRenderInfo (*RunBlocksSignature)(BlocksContext *, BlocksInput *);
 
 struct WorldUniforms {
     float transform[16];
@@ -36,6 +36,7 @@ static RunBlocksSignature runBlocks = 0;
 static char **shaderSource = 0;
 
 static void *blocksMem = 0;
+static BlocksContext *blocksContext = 0;
 
 NSString *getLibPath() {
 #if TARGET_OS_OSX
@@ -49,6 +50,14 @@ NSString *getLibPath() {
 #endif
 }
 
+void *allocateBlocksMemory(umm size) {
+    return malloc(size);
+}
+
+void freeBlocksMemory(void *mem, umm size) {
+    free(mem);
+}
+
 NSDate *getLastWriteTime(NSString *filePath) {
     NSDictionary<NSFileAttributeKey, id> *attrs = [NSFileManager.defaultManager attributesOfItemAtPath:filePath error:nil];
     return (NSDate *)attrs[NSFileModificationDate];
@@ -60,7 +69,7 @@ void loadLibBlocks() {
     const char *libPathRaw = [libPath fileSystemRepresentation];
     
     libBlocks = dlopen(libPathRaw, RTLD_LAZY|RTLD_LOCAL);
-    initBlocks = (InitBlocksSignature)dlsym(libBlocks, "InitBlocks");
+    initBlocks = (InitBlocksSignature)dlsym(libBlocks, "InitBlocksWithAllocator");
     runBlocks = (RunBlocksSignature)dlsym(libBlocks, "RunBlocks");
     shaderSource = (char **)dlsym(libBlocks, "BlocksShaders_Metal");
     lastLibWriteTime = getLastWriteTime(libPath);
@@ -83,16 +92,18 @@ void unloadLibBlocks() {
     id <MTLCommandQueue> _commandQueue;
 
     id <MTLBuffer> _vertBuffers[MAX_BUFFERS_IN_FLIGHT];
-    id <MTLBuffer> _worldUniformsBuffers[MAX_BUFFERS_IN_FLIGHT];
+    id <MTLBuffer> _indexBuffers[MAX_BUFFERS_IN_FLIGHT];
+    id <MTLBuffer> _instanceBuffers[MAX_BUFFERS_IN_FLIGHT];
+    id <MTLBuffer> _templateBuffer;
     
-    id <MTLTexture> blockSdfTexture;
-    id <MTLTexture> fontSdfTexture;
+    id <MTLTexture> atlasSdfTexture;
     id <MTLTexture> blockMipTexture;
     
     id<MTLSamplerState> _sampler;
     
     id <MTLRenderPipelineState> _sdfPipelineState;
     id <MTLRenderPipelineState> _mipPipelineState;
+    id <MTLRenderPipelineState> _instancedPipelineState;
     MTLVertexDescriptor *_mtlVertexDescriptor;
 
     uint8_t _bufferIndex;
@@ -129,25 +140,33 @@ void unloadLibBlocks() {
         // Position
     _mtlVertexDescriptor.attributes[0].format = MTLVertexFormatFloat2;
     _mtlVertexDescriptor.attributes[0].bufferIndex = 0;
-    _mtlVertexDescriptor.attributes[0].offset = 0;
+    _mtlVertexDescriptor.attributes[0].offset = offsetof(BlocksVertex, P);
+    
+#ifdef BLOCKS_COMPACT_VERTICES
+    MTLVertexFormat uvFormat = MTLVertexFormatUShort2Normalized;
+    MTLVertexFormat colorFormat = MTLVertexFormatUChar4Normalized;
+#else
+    MTLVertexFormat uvFormat = MTLVertexFormatFloat2;
+    MTLVertexFormat colorFormat = MTLVertexFormatFloat4;
+#endif
     
         // Tex UV
-    _mtlVertexDescriptor.attributes[1].format = MTLVertexFormatFloat2;
+    _mtlVertexDescriptor.attributes[1].format = uvFormat;
     _mtlVertexDescriptor.attributes[1].bufferIndex = 0;
-    _mtlVertexDescriptor.attributes[1].offset = 2 * sizeof(f32);
+    _mtlVertexDescriptor.attributes[1].offset = offsetof(BlocksVertex, uv);
     
         // Color
-    _mtlVertexDescriptor.attributes[2].format = MTLVertexFormatFloat4;
+    _mtlVertexDescriptor.attributes[2].format = colorFormat;
     _mtlVertexDescriptor.attributes[2].bufferIndex = 0;
-    _mtlVertexDescriptor.attributes[2].offset = 4 * sizeof(f32);
+    _mtlVertexDescriptor.attributes[2].offset = offsetof(BlocksVertex, color);
     
         // Outline Color
-    _mtlVertexDescriptor.attributes[3].format = MTLVertexFormatFloat4;
+    _mtlVertexDescriptor.attributes[3].format = colorFormat;
     _mtlVertexDescriptor.attributes[3].bufferIndex = 0;
-    _mtlVertexDescriptor.attributes[3].offset = 8 * sizeof(f32);
+    _mtlVertexDescriptor.attributes[3].offset = offsetof(BlocksVertex, outline);
     
         // Stride
-    _mtlVertexDescriptor.layouts[0].stride = 12 * sizeof(f32);
+    _mtlVertexDescriptor.layouts[0].stride = sizeof(BlocksVertex);
     _mtlVertexDescriptor.layouts[0].stepFunction = MTLVertexStepFunctionPerVertex;
 
     // Sampler
@@ -164,32 +183,32 @@ void unloadLibBlocks() {
     // Setup rendering pipelines
     [self buildRenderPipelines];
 
-    // Allocate buffers for GPU data
+    // Allocate buffers for GPU data. These are just starting sizes; drawInMTKView grows them as needed.
     for(u32 i = 0; i < MAX_BUFFERS_IN_FLIGHT; ++i)
     {
         static const u32 BLOCK_BYTE_SIZE = 12 * 2 * sizeof(f32);
         _vertBuffers[i] = [_device newBufferWithLength:(BLOCK_BYTE_SIZE * MAX_BLOCKS) options:MTLResourceStorageModeShared];
         _vertBuffers[i].label = @"Vertex Buffer";
         
-        _worldUniformsBuffers[i] = [_device newBufferWithLength:(sizeof(WorldUniforms) * 5) options:MTLResourceStorageModeShared];
-        _worldUniformsBuffers[i].label = @"World Uniforms Buffer";
+        _indexBuffers[i] = [_device newBufferWithLength:(BLOCK_BYTE_SIZE * MAX_BLOCKS) options:MTLResourceStorageModeShared];
+        _indexBuffers[i].label = @"Index Buffer";
+        
+        _instanceBuffers[i] = [_device newBufferWithLength:(sizeof(BlocksInstance) * MAX_BLOCKS) options:MTLResourceStorageModeShared];
+        _instanceBuffers[i].label = @"Instance Buffer";
     }
     
-    // Load SDF block texture
+    // Blocks and text share one SDF atlas, laid out the way libBlocks expects it
     MTLTextureDescriptor *texDescriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatR8Unorm 
-                                                                                             width:256 
-                                                                                            height:256 
+                                                                                             width:BLOCKS_ATLAS_WIDTH 
+                                                                                            height:BLOCKS_ATLAS_HEIGHT 
                                                                                          mipmapped:false];
-    blockSdfTexture = [_device newTextureWithDescriptor:texDescriptor];
+    atlasSdfTexture = [_device newTextureWithDescriptor:texDescriptor];
     
     NSData *texData = [NSData dataWithContentsOfURL:[NSBundle.mainBundle URLForResource:@"blocks-atlas-small" withExtension:@"dat"]];
-    [blockSdfTexture replaceRegion:MTLRegionMake2D(0, 0, 256, 256) mipmapLevel:0 withBytes:texData.bytes bytesPerRow:256];
-    
-    // Load font texture
-    fontSdfTexture = [_device newTextureWithDescriptor:texDescriptor];
+    [atlasSdfTexture replaceRegion:MTLRegionMake2D(0, 0, 256, 256) mipmapLevel:0 withBytes:texData.bytes bytesPerRow:256];
     
     NSData *fontData = [NSData dataWithContentsOfURL:[NSBundle.mainBundle URLForResource:@"font-atlas-small" withExtension:@"dat"]];
-    [fontSdfTexture replaceRegion:MTLRegionMake2D(0, 0, 256, 256) mipmapLevel:0 withBytes:fontData.bytes bytesPerRow:256];
+    [atlasSdfTexture replaceRegion:MTLRegionMake2D(BLOCKS_ATLAS_FONT_X, 0, 256, 256) mipmapLevel:0 withBytes:fontData.bytes bytesPerRow:256];
     
     // Load mipmapped textures
     MTLTextureDescriptor *mipTexDescriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatR8Unorm 
@@ -206,9 +225,11 @@ void unloadLibBlocks() {
     }
     
     // Init Blocks Memory
-    u32 memSize = Megabytes(128);
+    // Start small and let libBlocks ask for more as the workspace grows
+    umm memSize = Megabytes(4);
     blocksMem = malloc(memSize);
-    initBlocks(blocksMem, memSize);
+    BlocksAllocator allocator = { allocateBlocksMemory, freeBlocksMemory };
+    blocksContext = initBlocks(blocksMem, memSize, allocator);
 
     _commandQueue = [_device newCommandQueue];
 }
@@ -217,8 +238,14 @@ void unloadLibBlocks() {
     // Set up shaders
     NSString *nsShaderSource = [NSString stringWithUTF8String:*shaderSource];
     
+    // The shader structs have to match how libBlocks was built
+    MTLCompileOptions *compileOptions = [[MTLCompileOptions alloc] init];
+#ifdef BLOCKS_COMPACT_VERTICES
+    compileOptions.preprocessorMacros = @{ @"BLOCKS_COMPACT_VERTICES" : @1 };
+#endif
+    
     NSError *shaderError = nil;
-    id<MTLLibrary> library = [_device newLibraryWithSource:nsShaderSource options:nil error:&shaderError];
+    id<MTLLibrary> library = [_device newLibraryWithSource:nsShaderSource options:compileOptions error:&shaderError];
     if (shaderError) {
         NSLog(@"%@", shaderError.localizedDescription);
         return;
@@ -267,6 +294,23 @@ void unloadLibBlocks() {
     {
         NSLog(@"Failed to created pipeline state, error %@", error);
     }
+    
+#ifdef BLOCKS_INSTANCED_BLOCKS
+    // Instances fetch their own data, so there's no vertex descriptor here
+    MTLRenderPipelineDescriptor *instancedPipelineStateDescriptor = [sdfPipelineStateDescriptor copy];
+    instancedPipelineStateDescriptor.vertexFunction = [library newFunctionWithName:@"InstancedBlockVertex"];
+    instancedPipelineStateDescriptor.vertexDescriptor = nil;
+    
+    error = NULL;
+    _instancedPipelineState = [_device newRenderPipelineStateWithDescriptor:instancedPipelineStateDescriptor error:&error];
+    if (!_instancedPipelineState)
+    {
+        NSLog(@"Failed to created pipeline state, error %@", error);
+    }
+    
+    // Templates live in libBlocks' memory, so pick them up again after a reload
+    _templateBuffer = nil;
+#endif
 }
 
 - (CGPoint)_unprojectPoint:(CGPoint)point inView:(MetalView *)view {
@@ -326,6 +370,18 @@ void unloadLibBlocks() {
 ////    }
 //}
 
+// libBlocks doesn't cap how much it draws, so a frame's data can outgrow the buffers at any point.
+// Returns the buffer if it's big enough, otherwise a new one with some room to spare.
+- (id <MTLBuffer>)growBuffer:(id <MTLBuffer>)buffer toFit:(umm)size {
+    if (size <= buffer.length) {
+        return buffer;
+    }
+    
+    id <MTLBuffer> newBuffer = [_device newBufferWithLength:(size + size / 2) options:MTLResourceStorageModeShared];
+    newBuffer.label = buffer.label;
+    return newBuffer;
+}
+
 - (void)drawInMTKView:(nonnull MetalView *)view
 {
     // Load/Reload dylib if necessary
@@ -370,9 +426,6 @@ void unloadLibBlocks() {
     view->_input.wheelDx = 0;
     view->_input.wheelDy = 0;
     
-    id <MTLBuffer> vertBuffer = _vertBuffers[_bufferIndex];
-    id <MTLBuffer> worldUniformsBuffer = _worldUniformsBuffers[_bufferIndex];
-    
     MTLRenderPassDescriptor* renderPassDescriptor = view.currentRenderPassDescriptor;
     if(renderPassDescriptor != nil)
     {
@@ -380,14 +433,28 @@ void unloadLibBlocks() {
         
         [self beginImGuiWithView:view renderPassDescriptor:renderPassDescriptor]; 
         
-        BlocksRenderInfo renderInfo = runBlocks(blocksMem, &blocksInput);
+        BlocksRenderInfo renderInfo = runBlocks(blocksContext, &blocksInput);
+        
+        // The semaphore means the GPU is done with this frame's buffers, so they're safe to replace
+        _vertBuffers[_bufferIndex] = [self growBuffer:_vertBuffers[_bufferIndex] toFit:renderInfo.vertexDataSize];
+        _indexBuffers[_bufferIndex] = [self growBuffer:_indexBuffers[_bufferIndex] toFit:renderInfo.indexDataSize];
+        id <MTLBuffer> vertBuffer = _vertBuffers[_bufferIndex];
+        id <MTLBuffer> indexBuffer = _indexBuffers[_bufferIndex];
         memcpy(vertBuffer.contents, renderInfo.vertexData, renderInfo.vertexDataSize);
+        memcpy(indexBuffer.contents, renderInfo.indexData, renderInfo.indexDataSize);
+#ifdef BLOCKS_INSTANCED_BLOCKS
+        _instanceBuffers[_bufferIndex] = [self growBuffer:_instanceBuffers[_bufferIndex] toFit:renderInfo.instanceDataSize];
+        id <MTLBuffer> instanceBuffer = _instanceBuffers[_bufferIndex];
+        memcpy(instanceBuffer.contents, renderInfo.instanceData, renderInfo.instanceDataSize);
         
-        WorldUniforms *worldUniforms = (WorldUniforms *)[worldUniformsBuffer contents];
-        for (u32 i = 0; i < renderInfo.drawCallCount; ++i) {
-            BlocksDrawCall *drawCall = &renderInfo.drawCalls[i];
-            memcpy(worldUniforms + i, &drawCall->transform, sizeof(WorldUniforms));
+        // Templates never change, so they only get uploaded once
+        if (!_templateBuffer) {
+            _templateBuffer = [_device newBufferWithBytes:renderInfo.templateVertices 
+                                                   length:(renderInfo.templateCount * renderInfo.templateVertexStride * sizeof(BlocksTemplateVertex)) 
+                                                  options:MTLResourceStorageModeShared];
+            _templateBuffer.label = @"Block Template Buffer";
         }
+#endif
         
         id <MTLRenderCommandEncoder> renderEncoder = [commandBuffer renderCommandEncoderWithDescriptor:renderPassDescriptor];
         renderEncoder.label = @"BlocksRenderEncoder";
@@ -396,22 +463,48 @@ void unloadLibBlocks() {
         
         // Render data from libBlocks
         [renderEncoder setVertexBuffer:vertBuffer offset:0 atIndex:0];
-        [renderEncoder setVertexBuffer:worldUniformsBuffer offset:0 atIndex:1];
+#ifdef BLOCKS_INSTANCED_BLOCKS
+        [renderEncoder setVertexBuffer:_templateBuffer offset:0 atIndex:2];
+        [renderEncoder setVertexBuffer:instanceBuffer offset:0 atIndex:3];
+        [renderEncoder setVertexBytes:&renderInfo.templateVertexStride length:sizeof(u32) atIndex:4];
+#endif
         
-        [renderEncoder setFragmentTexture:blockSdfTexture atIndex:0];
+        [renderEncoder setFragmentTexture:atlasSdfTexture atIndex:0];
         [renderEncoder setFragmentSamplerState:_sampler atIndex:0];
         
         for (u32 i = 0; i < renderInfo.drawCallCount; ++i) {
             BlocksDrawCall *drawCall = &renderInfo.drawCalls[i];
             
-            if (i == renderInfo.drawCallCount - 1) {
-                [renderEncoder setFragmentTexture:fontSdfTexture atIndex:0];
+            // There can be any number of draw calls, so each one's transform goes inline instead of in a buffer
+            [renderEncoder setVertexBytes:&drawCall->transform length:sizeof(WorldUniforms) atIndex:1];
+#ifdef BLOCKS_INSTANCED_BLOCKS
+            if (drawCall->instanceCount) {
+                [renderEncoder setRenderPipelineState:_instancedPipelineState];
+                [renderEncoder drawPrimitives:MTLPrimitiveTypeTriangle 
+                                  vertexStart:0 
+                                  vertexCount:renderInfo.templateVertexStride 
+                                instanceCount:drawCall->instanceCount 
+                                 baseInstance:drawCall->instanceOffset];
+                [renderEncoder setRenderPipelineState:_sdfPipelineState];
             }
-            
-            [renderEncoder setVertexBufferOffset:(i * sizeof(WorldUniforms)) atIndex:1];
+#endif
+#ifdef BLOCKS_INDEXED_QUADS
+            if (drawCall->indexCount == 0) {
+                continue;
+            }
+            [renderEncoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                                      indexCount:drawCall->indexCount
+                                       indexType:(renderInfo.indexSize == sizeof(u16)) ? MTLIndexTypeUInt16 : MTLIndexTypeUInt32
+                                     indexBuffer:indexBuffer
+                               indexBufferOffset:drawCall->indexOffset * renderInfo.indexSize
+                                   instanceCount:1
+                                      baseVertex:drawCall->vertexOffset
+                                    baseInstance:0];
+#else
             [renderEncoder drawPrimitives:MTLPrimitiveTypeTriangle 
                               vertexStart:drawCall->vertexOffset 
                               vertexCount:drawCall->vertexCount];
+#endif
         }
         
         [self endImGuiWithCommandBuffer:commandBuffer renderEncoder:renderEncoder];
@@ -1,7 +1,7 @@
 # Build blocks.wasm
 
 mkdir build
-emcc -g ../../Blocks/Blocks.cpp -o build/blocks.js -s EXPORTED_FUNCTIONS='["_InitBlocks", "_RunBlocks"]' -s EXPORTED_RUNTIME_METHODS='["ccall", "cwrap", "getValue", "setValue"]'
+emcc -g -DBLOCKS_32BIT_MEMORY -DBLOCKS_COMPACT_VERTICES -DBLOCKS_INDEXED_QUADS -DBLOCKS_INSTANCED_BLOCKS ../../Blocks/Blocks.cpp -o build/blocks.js -s EXPORTED_FUNCTIONS='["_InitBlocks", "_RunBlocks"]' -s EXPORTED_RUNTIME_METHODS='["ccall", "cwrap", "getValue", "setValue"]'
 cp index.html build/index.html
 cp imblocks.js build/imblocks.js
 cp -r textures build/textures
@@ -1,7 +1,9 @@
 ;(function(){
   
-  var gl, programInfo, vertexBuffer, blockTex, fontTex, renderInfo;
+  var gl, instancing, programInfo, vertexBuffer, indexBuffer, atlasTex, renderInfo;
+  var instanceBuffer, templateVertexBuffer, templateTex;
   var blocksMem;
+  var blocksContext;
   
   var blocksResult;
   var blocksInputBuf;
@@ -43,15 +45,25 @@
     }
     
     gl.getExtension('OES_standard_derivatives');
+    gl.getExtension('OES_element_index_uint'); // Frames with a lot of quads come with 32-bit indices
+    
+    // Blocks and text come as instances of templates (see build.sh). The templates go in a float texture
+    // that the vertex shader looks up.
+    instancing = gl.getExtension('ANGLE_instanced_arrays');
+    if (!instancing || !gl.getExtension('OES_texture_float') || gl.getParameter(gl.MAX_VERTEX_TEXTURE_IMAGE_UNITS) === 0) {
+      alert("Unable to initialize WebGL. Your browser or machine doesn't support instancing or vertex textures.");
+      return;
+    }
     
     gl.enable(gl.BLEND);
     gl.blendFunc(gl.SRC_ALPHA, gl.ONE_MINUS_SRC_ALPHA);
     
     programInfo = initShaders(gl);
     vertexBuffer = gl.createBuffer();
+    indexBuffer = gl.createBuffer();
+    instanceBuffer = gl.createBuffer();
     
-    blockTex = loadTexture(gl, 'textures/blocks-atlas-small-sdf.png');
-    fontTex = loadTexture(gl, 'textures/font-atlas-small.png');
+    atlasTex = loadAtlas(gl, 'textures/blocks-atlas-small-sdf.png', 'textures/font-atlas-small.png');
     
     canvas.addEventListener('mousemove', function(e) {
       input.mouseP.x = e.offsetX;
@@ -100,7 +112,7 @@
     
     initBlocks();
     
-    blocksResult = Module._malloc(1024);
+    blocksResult = Module._malloc(64);
     blocksInputBuf = Module._malloc(8 * 4);
     
     window.requestAnimationFrame(tick);
@@ -108,10 +120,45 @@
   
   function tick(timestamp) {
     renderInfo = runBlocks();
-    draw(gl, programInfo, vertexBuffer, blockTex, fontTex, renderInfo);
+    if (!templateTex) {
+      uploadTemplates(gl, renderInfo);
+    }
+    draw(gl, programInfo, vertexBuffer, indexBuffer, atlasTex, renderInfo);
     window.requestAnimationFrame(tick);
   }
   
+  function compileProgram(gl, vertexShaderSource, fragShaderSource) {
+    const vertShader = gl.createShader(gl.VERTEX_SHADER);
+    gl.shaderSource(vertShader, vertexShaderSource);
+    gl.compileShader(vertShader);
+    if (!gl.getShaderParameter(vertShader, gl.COMPILE_STATUS)) {
+      alert('An error occurred compiling the shaders: ' + gl.getShaderInfoLog(vertShader));
+      gl.deleteShader(vertShader);
+      return;
+    }
+    
+    const fragShader = gl.createShader(gl.FRAGMENT_SHADER);
+    gl.shaderSource(fragShader, fragShaderSource);
+    gl.compileShader(fragShader);
+    if (!gl.getShaderParameter(fragShader, gl.COMPILE_STATUS)) {
+      alert('An error occurred compiling the shaders: ' + gl.getShaderInfoLog(fragShader));
+      gl.deleteShader(fragShader);
+      return;
+    }
+    
+    const shaderProgram = gl.createProgram();
+    gl.attachShader(shaderProgram, vertShader);
+    gl.attachShader(shaderProgram, fragShader);
+    gl.linkProgram(shaderProgram);
+
+    if (!gl.getProgramParameter(shaderProgram, gl.LINK_STATUS)) {
+      alert('Unable to initialize the shader program: ' + gl.getProgramInfoLog(shaderProgram));
+      return;
+    }
+    
+    return shaderProgram;
+  }
+  
   function initShaders(gl) {
     const vertexShaderSource = `
       attribute vec2 position;
@@ -134,6 +181,37 @@
       }
     `;
     
+    // Same as InstancedBlockVertex in the Metal example. Each template vertex is two texels of the
+    // template texture, one row per template: (offset, stretch) and then (uv, unused).
+    const instancedVertexShaderSource = `
+      attribute float templateVertex;
+      attribute vec2 instanceP;
+      attribute vec2 instanceStretch;
+      attribute float instanceScale;
+      attribute float templateIndex;
+      attribute vec4 color;
+      attribute vec4 outline;
+      
+      uniform mat4 projection;
+      uniform sampler2D templates;
+      uniform vec2 templatesSize;
+      
+      varying highp vec2 vertUV;
+      varying lowp vec4 vertColor;
+      varying lowp vec4 vertOutline;
+      
+      void main() {
+        vec2 texel = vec2((templateVertex * 2.0) + 0.5, templateIndex + 0.5) / templatesSize;
+        vec4 shape = texture2D(templates, texel);
+        vec4 uv = texture2D(templates, texel + vec2(1.0 / templatesSize.x, 0.0));
+        vec2 position = ((shape.xy * instanceScale) + instanceP) + (shape.zw * instanceStretch);
+        vertUV = uv.xy;
+        vertColor = color;
+        vertOutline = outline;
+        gl_Position = projection * vec4(position, 0, 1.0);
+      }
+    `;
+    
     const fragShaderSource = `
       #extension GL_OES_standard_derivatives : enable
       
@@ -160,31 +238,9 @@
       }
     `;
     
-    const vertShader = gl.createShader(gl.VERTEX_SHADER);
-    gl.shaderSource(vertShader, vertexShaderSource);
-    gl.compileShader(vertShader);
-    if (!gl.getShaderParameter(vertShader, gl.COMPILE_STATUS)) {
-      alert('An error occurred compiling the shaders: ' + gl.getShaderInfoLog(vertShader));
-      gl.deleteShader(vertShader);
-      return;
-    }
-    
-    const fragShader = gl.createShader(gl.FRAGMENT_SHADER);
-    gl.shaderSource(fragShader, fragShaderSource);
-    gl.compileShader(fragShader);
-    if (!gl.getShaderParameter(fragShader, gl.COMPILE_STATUS)) {
-      alert('An error occurred compiling the shaders: ' + gl.getShaderInfoLog(fragShader));
-      gl.deleteShader(fragShader);
-      return;
-    }
-    
-    const shaderProgram = gl.createProgram();
-    gl.attachShader(shaderProgram, vertShader);
-    gl.attachShader(shaderProgram, fragShader);
-    gl.linkProgram(shaderProgram);
-
-    if (!gl.getProgramParameter(shaderProgram, gl.LINK_STATUS)) {
-      alert('Unable to initialize the shader program: ' + gl.getProgramInfoLog(shaderProgram));
+    const shaderProgram = compileProgram(gl, vertexShaderSource, fragShaderSource);
+    const instancedProgram = compileProgram(gl, instancedVertexShaderSource, fragShaderSource);
+    if (!shaderProgram || !instancedProgram) {
       return;
     }
     
@@ -200,39 +256,65 @@
         projection: gl.getUniformLocation(shaderProgram, 'projection'),
         samplr: gl.getUniformLocation(shaderProgram, 'samplr'),
       },
+      instanced: {
+        program: instancedProgram,
+        attribs: {
+          templateVertex: gl.getAttribLocation(instancedProgram, 'templateVertex'),
+          instanceP: gl.getAttribLocation(instancedProgram, 'instanceP'),
+          instanceStretch: gl.getAttribLocation(instancedProgram, 'instanceStretch'),
+          instanceScale: gl.getAttribLocation(instancedProgram, 'instanceScale'),
+          templateIndex: gl.getAttribLocation(instancedProgram, 'templateIndex'),
+          color: gl.getAttribLocation(instancedProgram, 'color'),
+          outline: gl.getAttribLocation(instancedProgram, 'outline'),
+        },
+        uniforms: {
+          projection: gl.getUniformLocation(instancedProgram, 'projection'),
+          samplr: gl.getUniformLocation(instancedProgram, 'samplr'),
+          templates: gl.getUniformLocation(instancedProgram, 'templates'),
+          templatesSize: gl.getUniformLocation(instancedProgram, 'templatesSize'),
+        },
+      },
     };
     
     return programInfo;
   }
   
-  function loadTexture(gl, url) {
+  // Blocks and text share one SDF atlas: the block atlas on the left and the font atlas
+  // on the right (see BLOCKS_ATLAS_WIDTH and friends in Blocks.h)
+  const ATLAS_WIDTH = 512;
+  const ATLAS_HEIGHT = 256;
+  const ATLAS_FONT_X = 256;
+  
+  function loadAtlas(gl, blocksUrl, fontUrl) {
     const texture = gl.createTexture();
     gl.bindTexture(gl.TEXTURE_2D, texture);
 
     const level = 0;
     const internalFormat = gl.LUMINANCE;
-    const width = 1;
-    const height = 1;
     const border = 0;
     const srcFormat = gl.LUMINANCE;
     const srcType = gl.UNSIGNED_BYTE;
-    const pixel = new Uint8Array([0]);
+    const pixels = new Uint8Array(ATLAS_WIDTH * ATLAS_HEIGHT);
     gl.texImage2D(gl.TEXTURE_2D, level, internalFormat,
-                  width, height, border, srcFormat, srcType,
-                  pixel);
-
-    const image = new Image();
-    image.onload = function() {
-      gl.bindTexture(gl.TEXTURE_2D, texture);
-      gl.texImage2D(gl.TEXTURE_2D, level, internalFormat,
-                    srcFormat, srcType, image);
-      
-      gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.NEAREST);
-      gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.LINEAR);
-      gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
-      gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
-    };
-    image.src = url;
+                  ATLAS_WIDTH, ATLAS_HEIGHT, border, srcFormat, srcType,
+                  pixels);
+    
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.NEAREST);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.LINEAR);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+    
+    function loadRegion(url, x) {
+      const image = new Image();
+      image.onload = function() {
+        gl.bindTexture(gl.TEXTURE_2D, texture);
+        gl.texSubImage2D(gl.TEXTURE_2D, level, x, 0,
+                         srcFormat, srcType, image);
+      };
+      image.src = url;
+    }
+    loadRegion(blocksUrl, 0);
+    loadRegion(fontUrl, ATLAS_FONT_X);
 
     return texture;
   }
@@ -240,7 +322,7 @@
   function initBlocks() {
     const MEM_SIZE = 1024 * 1024 * 4;
     blocksMem = Module._malloc(MEM_SIZE);
-    Module._InitBlocks(blocksMem, MEM_SIZE);
+    blocksContext = Module._InitBlocks(blocksMem, MEM_SIZE);
   }
     
   function runBlocks() {
@@ -255,53 +337,152 @@
     Module.setValue(blocksInputBuf + (4 * 6), input.wheelDelta.y, 'float');
     Module.setValue(blocksInputBuf + (4 * 7), input.commandDown ? 1 : 0, 'i32');
     
-    Module._RunBlocks(blocksResult, blocksMem, blocksInputBuf);
+    Module._RunBlocks(blocksResult, blocksContext, blocksInputBuf);
     
     var vertexData = Module.getValue(blocksResult, 'i32');
     var vertexDataSize = Module.getValue(blocksResult + 4, 'i32');
+    var indexData = Module.getValue(blocksResult + 8, 'i32');
+    var indexDataSize = Module.getValue(blocksResult + 12, 'i32');
+    var indexSize = Module.getValue(blocksResult + 16, 'i32');
     
-    var drawCallCount = Module.getValue(blocksResult + 1160, 'i32');
+    // The draw calls live in libBlocks' frame arena, so they're read straight out of it
+    var instanceData = Module.getValue(blocksResult + 20, 'i32');
+    var instanceDataSize = Module.getValue(blocksResult + 24, 'i32');
+    var templateVertices = Module.getValue(blocksResult + 28, 'i32');
+    var templateVertexStride = Module.getValue(blocksResult + 36, 'i32');
+    var templateCount = Module.getValue(blocksResult + 40, 'i32');
+    
+    var drawCallBase = Module.getValue(blocksResult + 44, 'i32');
+    var drawCallCount = Module.getValue(blocksResult + 48, 'i32');
     
     var drawCalls = [];
-    var drawCallBase = blocksResult + 8;
-    var drawCallSize = 18 * 4;
-    for (var i = 0; i < 16; ++i) {
-      var drawCall = {transform: [], vertexCount: 0, vertexOffset: 0};
+    var drawCallSize = 22 * 4;
+    for (var i = 0; i < drawCallCount; ++i) {
+      var drawCall = {transform: [], vertexCount: 0, vertexOffset: 0, indexCount: 0, indexOffset: 0, instanceCount: 0, instanceOffset: 0};
       for (var j = 0; j < 16; ++j) {
         drawCall.transform.push(Module.getValue(drawCallBase + (drawCallSize * i) + (j * 4), 'float'));
       }
       drawCall.vertexCount = Module.getValue(drawCallBase + (drawCallSize * i) + (16 * 4), 'i32');
       drawCall.vertexOffset = Module.getValue(drawCallBase + (drawCallSize * i) + (17 * 4), 'i32');
+      drawCall.indexCount = Module.getValue(drawCallBase + (drawCallSize * i) + (18 * 4), 'i32');
+      drawCall.indexOffset = Module.getValue(drawCallBase + (drawCallSize * i) + (19 * 4), 'i32');
+      drawCall.instanceCount = Module.getValue(drawCallBase + (drawCallSize * i) + (20 * 4), 'i32');
+      drawCall.instanceOffset = Module.getValue(drawCallBase + (drawCallSize * i) + (21 * 4), 'i32');
       drawCalls.push(drawCall);
     }
     
     return {
       vertexData: vertexData,
       vertexDataSize: vertexDataSize,
+      indexData: indexData,
+      indexDataSize: indexDataSize,
+      indexSize: indexSize,
+      instanceData: instanceData,
+      instanceDataSize: instanceDataSize,
+      templateVertices: templateVertices,
+      templateVertexStride: templateVertexStride,
+      templateCount: templateCount,
       drawCalls: drawCalls,
       drawCallCount: drawCallCount
     };
     
   }
   
-  function draw(gl, programInfo, vertexBuffer, blockTex, fontTex, renderInfo) {
-    
-    var vertexData = renderInfo.vertexData;
-    var vertexDataSize = renderInfo.vertexDataSize;
+  // Matches BlocksVertex with -DBLOCKS_COMPACT_VERTICES (see build.sh): f32 position, unorm16 UVs, RGBA8 colors
+  const vertexStride = 20;
+  
+  // Matches BlocksTemplateVertex and BlocksInstance with -DBLOCKS_COMPACT_VERTICES
+  const templateVertexSize = 20;
+  const instanceStride = 32;
+  
+  // The templates don't change after InitBlocks, so this only happens for the first frame
+  function uploadTemplates(gl, renderInfo) {
+    const vertexCount = renderInfo.templateCount * renderInfo.templateVertexStride;
+    const width = renderInfo.templateVertexStride * 2;
+    const height = renderInfo.templateCount;
+    const texels = new Float32Array(width * height * 4);
+    const floats = new Float32Array(Module.HEAPU8.buffer, renderInfo.templateVertices, vertexCount * (templateVertexSize / 4));
+    const uvs = new Uint16Array(Module.HEAPU8.buffer, renderInfo.templateVertices, vertexCount * (templateVertexSize / 2));
+    for (var i = 0; i < vertexCount; ++i) {
+      const src = i * (templateVertexSize / 4);
+      const dst = i * 8;
+      texels[dst + 0] = floats[src + 0]; // offset
+      texels[dst + 1] = floats[src + 1];
+      texels[dst + 2] = floats[src + 2]; // stretch
+      texels[dst + 3] = floats[src + 3];
+      texels[dst + 4] = uvs[(src + 4) * 2] / 65535.0;
+      texels[dst + 5] = uvs[(src + 4) * 2 + 1] / 65535.0;
+    }
     
-    // copy vertex data
+    templateTex = gl.createTexture();
+    gl.bindTexture(gl.TEXTURE_2D, templateTex);
+    gl.texImage2D(gl.TEXTURE_2D, 0, gl.RGBA, width, height, 0, gl.RGBA, gl.FLOAT, texels);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MIN_FILTER, gl.NEAREST);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_MAG_FILTER, gl.NEAREST);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+    gl.texParameteri(gl.TEXTURE_2D, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+    
+    // WebGL 1 has no vertex ID, so every instance reads which template vertex it's on from here
+    const templateVertexIndices = new Float32Array(renderInfo.templateVertexStride);
+    for (var i = 0; i < renderInfo.templateVertexStride; ++i) {
+      templateVertexIndices[i] = i;
+    }
+    templateVertexBuffer = gl.createBuffer();
+    gl.bindBuffer(gl.ARRAY_BUFFER, templateVertexBuffer);
+    gl.bufferData(gl.ARRAY_BUFFER, templateVertexIndices, gl.STATIC_DRAW);
+  }
+  
+  // Like bindVertexAttribs, WebGL 1 can't start at a base instance, so the per-instance attributes
+  // point at the draw call's first instance
+  function bindInstanceAttribs(gl, instanced, baseInstance) {
+    const base = baseInstance * instanceStride;
+    
+    gl.bindBuffer(gl.ARRAY_BUFFER, templateVertexBuffer);
+    gl.vertexAttribPointer(instanced.attribs.templateVertex, 1, gl.FLOAT, false, 0, 0);
+    gl.enableVertexAttribArray(instanced.attribs.templateVertex);
+    
+    // name: components, type, normalize, offset into BlocksInstance
+    const layout = [
+      ['instanceP',       2, gl.FLOAT,          false, 0],
+      ['instanceStretch', 2, gl.FLOAT,          false, 8],
+      ['instanceScale',   1, gl.FLOAT,          false, 16],
+      // WebGL 1 has no 32-bit integer attributes, but template indices fit in the low half (little endian)
+      ['templateIndex',   1, gl.UNSIGNED_SHORT, false, 20],
+      ['color',           4, gl.UNSIGNED_BYTE,  true,  24],
+      ['outline',         4, gl.UNSIGNED_BYTE,  true,  28],
+    ];
+    gl.bindBuffer(gl.ARRAY_BUFFER, instanceBuffer);
+    for (var i = 0; i < layout.length; ++i) {
+      const location = instanced.attribs[layout[i][0]];
+      gl.vertexAttribPointer(location, layout[i][1], layout[i][2], layout[i][3], instanceStride, base + layout[i][4]);
+      gl.enableVertexAttribArray(location);
+      instancing.vertexAttribDivisorANGLE(location, 1);
+    }
+  }
+  
+  // Divisors belong to attribute locations rather than programs, so they're put back before
+  // drawing plain vertices again
+  function unbindInstanceAttribs(gl, instanced) {
+    for (var name in instanced.attribs) {
+      instancing.vertexAttribDivisorANGLE(instanced.attribs[name], 0);
+      gl.disableVertexAttribArray(instanced.attribs[name]);
+    }
+  }
+  
+  // WebGL 1 can't offset indices by a base vertex, so each draw call points the attributes at its
+  // own first vertex instead
+  function bindVertexAttribs(gl, programInfo, baseVertex) {
+    const base = baseVertex * vertexStride;
     gl.bindBuffer(gl.ARRAY_BUFFER, vertexBuffer);
-    const vertData = Module.HEAPU8.subarray(vertexData, vertexData + vertexDataSize)
-    gl.bufferData(gl.ARRAY_BUFFER, vertData, gl.STATIC_DRAW);
     
     // Position
     {
       const numComponents = 2;  // pull out 2 values per iteration
       const type = gl.FLOAT;    // the data in the buffer is 32bit floats
       const normalize = false;  // don't normalize
-      const stride = 12 * 4;         // how many bytes to get from one set of values to the next
+      const stride = vertexStride;   // how many bytes to get from one set of values to the next
                                      // 0 = use type and numComponents above
-      const offset = 0;         // how many bytes inside the buffer to start from
+      const offset = base + 0;  // how many bytes inside the buffer to start from
       gl.vertexAttribPointer(
           programInfo.attribs.position,
           numComponents,
@@ -316,11 +497,11 @@
     // UVs
     {
       const numComponents = 2;  // pull out 2 values per iteration
-      const type = gl.FLOAT;    // the data in the buffer is 32bit floats
-      const normalize = false;  // don't normalize
-      const stride = 12 * 4;         // how many bytes to get from one set of values to the next
+      const type = gl.UNSIGNED_SHORT;  // unorm16
+      const normalize = true;   // map 0..65535 to 0..1
+      const stride = vertexStride;   // how many bytes to get from one set of values to the next
                                      // 0 = use type and numComponents above
-      const offset = 2 * 4;         // how many bytes inside the buffer to start from
+      const offset = base + 8;      // how many bytes inside the buffer to start from
       gl.vertexAttribPointer(
           programInfo.attribs.texCoords,
           numComponents,
@@ -335,11 +516,11 @@
     // Color
     {
       const numComponents = 4;  // pull out 2 values per iteration
-      const type = gl.FLOAT;    // the data in the buffer is 32bit floats
-      const normalize = false;  // don't normalize
-      const stride = 12 * 4;         // how many bytes to get from one set of values to the next
+      const type = gl.UNSIGNED_BYTE;  // RGBA8
+      const normalize = true;   // map 0..255 to 0..1
+      const stride = vertexStride;   // how many bytes to get from one set of values to the next
                                      // 0 = use type and numComponents above
-      const offset = 4 * 4;         // how many bytes inside the buffer to start from
+      const offset = base + 12;     // how many bytes inside the buffer to start from
       gl.vertexAttribPointer(
           programInfo.attribs.color,
           numComponents,
@@ -354,11 +535,11 @@
     // Outline
     {
       const numComponents = 4;  // pull out 2 values per iteration
-      const type = gl.FLOAT;    // the data in the buffer is 32bit floats
-      const normalize = false;  // don't normalize
-      const stride = 12 * 4;         // how many bytes to get from one set of values to the next
+      const type = gl.UNSIGNED_BYTE;  // RGBA8
+      const normalize = true;   // map 0..255 to 0..1
+      const stride = vertexStride;   // how many bytes to get from one set of values to the next
                                      // 0 = use type and numComponents above
-      const offset = 8 * 4;         // how many bytes inside the buffer to start from
+      const offset = base + 16;     // how many bytes inside the buffer to start from
       gl.vertexAttribPointer(
           programInfo.attribs.outline,
           numComponents,
@@ -369,7 +550,28 @@
       gl.enableVertexAttribArray(
           programInfo.attribs.outline);
     }
+  }
+  
+  function draw(gl, programInfo, vertexBuffer, indexBuffer, atlasTex, renderInfo) {
     
+    var vertexData = renderInfo.vertexData;
+    var vertexDataSize = renderInfo.vertexDataSize;
+    
+    // copy vertex data
+    gl.bindBuffer(gl.ARRAY_BUFFER, vertexBuffer);
+    const vertData = Module.HEAPU8.subarray(vertexData, vertexData + vertexDataSize)
+    gl.bufferData(gl.ARRAY_BUFFER, vertData, gl.STATIC_DRAW);
+    
+    // copy index data
+    gl.bindBuffer(gl.ELEMENT_ARRAY_BUFFER, indexBuffer);
+    const indexData = Module.HEAPU8.subarray(renderInfo.indexData, renderInfo.indexData + renderInfo.indexDataSize)
+    gl.bufferData(gl.ELEMENT_ARRAY_BUFFER, indexData, gl.STATIC_DRAW);
+    const indexType = (renderInfo.indexSize === 2) ? gl.UNSIGNED_SHORT : gl.UNSIGNED_INT;
+    
+    // copy instance data
+    gl.bindBuffer(gl.ARRAY_BUFFER, instanceBuffer);
+    const instanceData = Module.HEAPU8.subarray(renderInfo.instanceData, renderInfo.instanceData + renderInfo.instanceDataSize)
+    gl.bufferData(gl.ARRAY_BUFFER, instanceData, gl.STATIC_DRAW);
     
     gl.clearColor(0x33 / 255.0, 0x47 / 255.0, 0x71 / 255.0, 1.0);
     gl.clear(gl.COLOR_BUFFER_BIT);
@@ -377,29 +579,47 @@
     gl.useProgram(programInfo.program);
     
     gl.activeTexture(gl.TEXTURE0);
-    gl.bindTexture(gl.TEXTURE_2D, blockTex);
+    gl.bindTexture(gl.TEXTURE_2D, atlasTex);
     gl.uniform1i(programInfo.uniforms.samplr, 0);
+    gl.activeTexture(gl.TEXTURE1);
+    gl.bindTexture(gl.TEXTURE_2D, templateTex);
+    
+    const instanced = programInfo.instanced;
+    gl.useProgram(instanced.program);
+    gl.uniform1i(instanced.uniforms.samplr, 0);
+    gl.uniform1i(instanced.uniforms.templates, 1);
+    gl.uniform2f(instanced.uniforms.templatesSize, renderInfo.templateVertexStride * 2, renderInfo.templateCount);
     
     for (var i = 0; i < renderInfo.drawCallCount; ++i) {
       var drawCall = renderInfo.drawCalls[i];
-      if (drawCall.vertexCount === 0) {
-        continue;
+      
+      const projection = drawCall.transform;
+      
+      // A draw call's instances come before its vertices
+      if (drawCall.instanceCount !== 0) {
+        gl.useProgram(instanced.program);
+        gl.uniformMatrix4fv(
+          instanced.uniforms.projection,
+          false,
+          projection);
+        
+        bindInstanceAttribs(gl, instanced, drawCall.instanceOffset);
+        instancing.drawArraysInstancedANGLE(gl.TRIANGLES, 0, renderInfo.templateVertexStride, drawCall.instanceCount);
+        unbindInstanceAttribs(gl, instanced);
       }
       
-      if (i === renderInfo.drawCallCount - 1) {
-        gl.activeTexture(gl.TEXTURE0);
-        gl.bindTexture(gl.TEXTURE_2D, fontTex);
-        gl.uniform1i(programInfo.uniforms.samplr, 0);
+      if (drawCall.vertexCount === 0) {
+        continue;
       }
-    
-      const projection = drawCall.transform;
       
+      gl.useProgram(programInfo.program);
       gl.uniformMatrix4fv(
         programInfo.uniforms.projection,
         false,
         projection);
       
-      gl.drawArrays(gl.TRIANGLES, drawCall.vertexOffset, drawCall.vertexCount);
+      bindVertexAttribs(gl, programInfo, drawCall.vertexOffset);
+      gl.drawElements(gl.TRIANGLES, drawCall.indexCount, indexType, drawCall.indexOffset * renderInfo.indexSize);
     }
     
   }